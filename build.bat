@@ -3,7 +3,7 @@ echo Building Huffman Compression Utility...
 
 :: Set compiler and flags
 set CXX=g++
-set CXXFLAGS=-std=c++11 -Wall -Wextra -Iinclude
+set CXXFLAGS=-std=c++11 -Wall -Wextra -pthread -Iinclude
 set TARGET=huff.exe
 
 :: Check if compiler exists
@@ -23,8 +23,19 @@ echo Compiling source files...
     main.cpp ^
     src/CommandLineOptions.cpp ^
     src/HuffmanException.cpp ^
-    src/HuffmanNode.cpp ^
     src/ArchiveStructures.cpp ^
+    src/ArchiveIO.cpp ^
+    src/BitStream.cpp ^
+    src/HuffmanCodeTable.cpp ^
+    src/HuffmanDecoder.cpp ^
+    src/ThreadPool.cpp ^
+    src/MappedFile.cpp ^
+    src/Crc32c.cpp ^
+    src/FrequencyTable.cpp ^
+    src/Lz77.cpp ^
+    src/Bwt.cpp ^
+    src/ContextModel.cpp ^
+    src/DeltaFilter.cpp ^
     src/HuffmanAlgorithm.cpp
 
 if %errorlevel% equ 0 (
@@ -0,0 +1,182 @@
+#pragma once
+#include "HuffmanException.h"
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Bounds-checked cursor for parsing an archive held in memory
+ *
+ * Reads fixed-width little-endian fields and byte ranges from a memory
+ * buffer, typically a memory-mapped archive. Byte ranges are returned as
+ * pointers into the buffer, so payloads are consumed in place without
+ * copying. Every read is checked against the end of the buffer.
+ */
+class ArchiveReader {
+private:
+    const unsigned char* data;   ///< Start of the archive bytes
+    size_t size;                 ///< Number of archive bytes
+    size_t pos;                  ///< Current read position
+
+public:
+    /**
+     * @brief Construct a new Archive Reader
+     *
+     * @param archiveData Pointer to the archive bytes
+     * @param archiveSize Number of archive bytes
+     */
+    ArchiveReader(const unsigned char* archiveData, size_t archiveSize);
+
+    /**
+     * @brief Read an unsigned 8-bit field
+     * @return uint8_t The field value
+     * @throws HuffmanException If the archive ends before the field
+     */
+    uint8_t readU8();
+
+    /**
+     * @brief Read an unsigned little-endian 16-bit field
+     * @return uint16_t The field value
+     * @throws HuffmanException If the archive ends before the field
+     */
+    uint16_t readU16();
+
+    /**
+     * @brief Read an unsigned little-endian 32-bit field
+     * @return uint32_t The field value
+     * @throws HuffmanException If the archive ends before the field
+     */
+    uint32_t readU32();
+
+    /**
+     * @brief Read an unsigned little-endian 64-bit field
+     * @return uint64_t The field value
+     * @throws HuffmanException If the archive ends before the field
+     */
+    uint64_t readU64();
+
+    /**
+     * @brief Read a 64-bit field holding a size or offset
+     *
+     * @return size_t The field value
+     * @throws HuffmanException If the archive ends before the field or the
+     *         value does not fit in size_t on this platform
+     */
+    size_t readSize();
+
+    /**
+     * @brief Read an IEEE-754 double stored as a little-endian 64-bit field
+     * @return double The field value
+     * @throws HuffmanException If the archive ends before the field
+     */
+    double readF64();
+
+    /**
+     * @brief Consume a range of bytes without copying it
+     *
+     * @param count Number of bytes to consume
+     * @return const unsigned char* Pointer to the first consumed byte
+     * @throws HuffmanException If the archive ends before the range
+     */
+    const unsigned char* readBytes(size_t count);
+
+    /**
+     * @brief Read a string of known length
+     *
+     * @param length Number of characters
+     * @return std::string The string
+     * @throws HuffmanException If the archive ends before the string
+     */
+    std::string readString(size_t length);
+
+    /**
+     * @brief Move the cursor to an absolute position
+     *
+     * @param position Offset from the start of the archive
+     * @throws HuffmanException If the position lies beyond the end
+     */
+    void seek(size_t position);
+
+    /**
+     * @brief Get the current read position
+     * @return size_t Offset from the start of the archive
+     */
+    size_t position() const;
+
+    /**
+     * @brief Get the number of bytes left after the cursor
+     * @return size_t Remaining bytes
+     */
+    size_t remaining() const;
+};
+
+/**
+ * @brief Byte buffer for building archive records
+ *
+ * Counterpart of ArchiveReader: appends fixed-width little-endian fields,
+ * so archives have the same layout on every platform and build. Records
+ * are assembled in memory and then written out in one piece.
+ */
+class ArchiveWriter {
+private:
+    std::vector<unsigned char> buffer;   ///< Bytes written so far
+
+public:
+    /**
+     * @brief Append an unsigned 8-bit field
+     * @param value Field value
+     */
+    void writeU8(uint8_t value);
+
+    /**
+     * @brief Append an unsigned little-endian 16-bit field
+     * @param value Field value
+     */
+    void writeU16(uint16_t value);
+
+    /**
+     * @brief Append an unsigned little-endian 32-bit field
+     * @param value Field value
+     */
+    void writeU32(uint32_t value);
+
+    /**
+     * @brief Append an unsigned little-endian 64-bit field
+     * @param value Field value
+     */
+    void writeU64(uint64_t value);
+
+    /**
+     * @brief Append an IEEE-754 double as a little-endian 64-bit field
+     * @param value Field value
+     */
+    void writeF64(double value);
+
+    /**
+     * @brief Append raw bytes
+     *
+     * @param bytes Pointer to the bytes
+     * @param count Number of bytes
+     */
+    void writeBytes(const void* bytes, size_t count);
+
+    /**
+     * @brief Get the bytes written so far
+     * @return const std::vector<unsigned char>& The buffer
+     */
+    const std::vector<unsigned char>& data() const;
+
+    /**
+     * @brief Get the number of bytes written so far
+     * @return size_t Buffer size
+     */
+    size_t size() const;
+
+    /**
+     * @brief Write the buffered bytes to a stream and empty the buffer
+     * @param out Destination stream
+     */
+    void flushTo(std::ostream& out);
+};
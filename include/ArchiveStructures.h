@@ -5,6 +5,9 @@
 #include <iostream>
 #include <cstdint>
 
+class ArchiveReader;
+class ArchiveWriter;
+
 /**
  * @brief Metadata for individual files within an archive
  * 
@@ -18,6 +21,8 @@ struct FileEntry {
     size_t originalSize;        ///< Size of file before compression
     size_t compressedSize;      ///< Size of file after compression
     size_t offsetInArchive;     ///< Byte offset where file data starts in archive
+    uint32_t checksum;          ///< CRC-32C of the file's original contents
+    uint64_t pieceOffset;       ///< Offset of this piece within its file (non-zero for a --shard piece continuing a file)
     
     /**
      * @brief Default constructor
@@ -47,11 +52,11 @@ struct CompressionStatistics {
     std::map<char, std::string> huffmanCodes; ///< Generated Huffman codes for each character
     std::map<char, int> codeLengths;        ///< Length of each Huffman code in bits
     double shannonInfo;                     ///< Shannon information content (theoretical optimum)
-    double huffmanAverage;                  ///< Average bits per character using Huffman coding
+    double huffmanAverage;                  ///< Average bits per character using Huffman coding (archives: order-0 coded and stored blocks only, 0 if none)
     double compressionRatio;                ///< Compression ratio as percentage
     size_t totalOriginalSize;               ///< Total size of all files before compression
     size_t totalCompressedSize;             ///< Total size of all files after compression
-    double efficiency;                      ///< Huffman efficiency vs Shannon limit
+    double efficiency;                      ///< Huffman efficiency vs Shannon limit (over the same blocks as huffmanAverage)
     
     /**
      * @brief Default constructor
@@ -142,3 +147,271 @@ struct ArchiveMetadata {
      */
     static ArchiveMetadata deserialize(const std::vector<uint8_t>& data);
 };
+
+/**
+ * @brief Byte range of one archive section
+ */
+struct ArchiveSection {
+    uint64_t offset;   ///< Byte offset of the section from the start of the archive
+    uint64_t length;   ///< Section length in bytes
+};
+
+/**
+ * @brief Fixed-size header at the start of every archive
+ * 
+ * All archive fields are explicit-width little-endian integers (doubles
+ * as their IEEE-754 bit pattern), so archives read the same on every
+ * platform. The header starts with a magic number and a format version,
+ * letting a reader reject other files after a few bytes, and lists the
+ * offset and length of every section so each one can be validated and
+ * read or mapped on its own.
+ * 
+ * Layout: magic (4), version (2), flags (2), header size (4), section
+ * count (4), block size (4), file count (4), original size (8), block
+ * count (8), then (offset, length) as 8 + 8 bytes per section.
+ */
+struct ArchiveHeader {
+    static const unsigned char kMagic[4];    ///< "HUF" followed by 0x1A
+    static const uint16_t kVersion = 10;     ///< Format version written and accepted
+    static const size_t kSize = 104;         ///< Header size in bytes
+    
+    /// Sections in the order they are stored
+    enum Section { CodeTables, Blocks, BlockIndex, Metadata, kSectionCount };
+    
+    uint16_t version;                        ///< Format version
+    uint16_t flags;                          ///< Reserved feature flags (0)
+    uint32_t blockSize;                      ///< Uncompressed bytes per block
+    uint32_t fileCount;                      ///< Number of files in the archive
+    uint64_t originalSize;                   ///< Total uncompressed size of all files
+    uint64_t blockCount;                     ///< Number of blocks
+    ArchiveSection sections[kSectionCount];  ///< Location of every section
+    
+    /**
+     * @brief Default constructor
+     * 
+     * Sets the current version and zeroes all counts and sections.
+     */
+    ArchiveHeader();
+    
+    /**
+     * @brief Append the header to a record buffer
+     * @param out Buffer receiving exactly kSize bytes
+     */
+    void writeTo(ArchiveWriter& out) const;
+    
+    /**
+     * @brief Parse and validate a header
+     * 
+     * @param reader Cursor positioned at the start of the archive
+     * @param archiveSize Total archive size, used to bounds-check the sections
+     * @return ArchiveHeader The header
+     * @throws HuffmanException If the magic number, version or section table is invalid
+     */
+    static ArchiveHeader parse(ArchiveReader& reader, uint64_t archiveSize);
+};
+
+/**
+ * @brief Location of one block inside an archive
+ * 
+ * The block index is stored after the last block and lets a decoder seek
+ * straight to any block, so blocks can be decoded independently and in
+ * parallel. Blocks never span files, so every block belongs to one file.
+ */
+struct BlockIndexEntry {
+    size_t archiveOffset;   ///< Byte offset of the block record from the start of the archive
+    size_t originalSize;    ///< Number of bytes the block decodes to
+    size_t fileIndex;       ///< Index of the file the block belongs to (not stored)
+    size_t outputOffset;    ///< Offset of the block's data within that file (not stored)
+    
+    /**
+     * @brief Default constructor
+     * 
+     * Initializes all offsets and sizes to zero.
+     */
+    BlockIndexEntry();
+};
+
+/**
+ * @brief Code tables shared by several blocks of an archive
+ * 
+ * Small blocks pay noticeably for carrying their own code lengths, so an
+ * archive may store a few code tables once and let blocks refer to them
+ * by index (at most 255 tables). On disk the code tables section is a table count (4 bytes)
+ * followed by 128 bytes of nibble-packed code lengths per table.
+ */
+struct SharedCodeTables {
+    std::vector<uint8_t> lengths;   ///< 256 code lengths per table, tables one after another
+    
+    /**
+     * @brief Get the number of tables
+     * @return size_t Table count
+     */
+    size_t count() const;
+    
+    /**
+     * @brief Get the code lengths of one table
+     * @param index Table number, below count()
+     * @return const uint8_t* Code length of each byte value (0 = unused)
+     */
+    const uint8_t* table(size_t index) const;
+    
+    /**
+     * @brief Append a table
+     * @param codeLengths Code length of each byte value (0 = unused)
+     * @return uint8_t Index of the new table
+     * @throws HuffmanException If the archive already holds the most tables a block can refer to
+     */
+    uint8_t add(const uint8_t codeLengths[256]);
+    
+    /**
+     * @brief Append the code tables section to a record buffer
+     * @param out Buffer receiving the section
+     */
+    void writeTo(ArchiveWriter& out) const;
+    
+    /**
+     * @brief Parse a code tables section
+     * 
+     * @param reader Cursor positioned at the start of the section
+     * @param length Section length in bytes
+     * @return SharedCodeTables The tables
+     * @throws HuffmanException If the length does not match the table count
+     */
+    static SharedCodeTables parse(ArchiveReader& reader, size_t length);
+};
+
+/**
+ * @brief One independently coded block of archive payload
+ * 
+ * Archives split the concatenated input into fixed-size blocks. Every block
+ * carries its own canonical code lengths or refers to one of the archive's
+ * shared code tables, so it can be encoded and decoded on its own with
+ * memory bounded by the block size.
+ * 
+ * The payload of a Coded block consists of kStreamCount interleaved
+ * bitstreams sharing the block's code table: byte i of the block is coded
+ * into stream i % kStreamCount. The streams are independent, so a decoder
+ * can advance all of them at once. A Stored block holds its bytes verbatim;
+ * the encoder uses it when coding would not save enough to be worth the
+ * decode cost (already compressed or encrypted data). A RunLength block
+ * codes only literals: every run of one byte value keeps its first byte as
+ * a literal, and a run list says after which literal the previous byte
+ * repeats and how many more times, so long runs cost a few bytes and
+ * decode as a memset. An Lz77 block (--method lz77) holds an LZ77 payload
+ * whose literals and match codes are themselves nested blocks; see Lz77.
+ * A Bwt block (--method bwt) holds a Burrows-Wheeler payload; see Bwt.
+ * A Context block (--order1) codes every byte with one of several code
+ * tables, chosen by the byte before it; see ContextModel. Any block but a
+ * Stored one may code delta-filtered bytes (--delta); see DeltaFilter.
+ * 
+ * On disk a block is stored as: original size (4 bytes), CRC-32C of the
+ * decoded data (4 bytes), mode (1 byte; kDeltaFlag set if the block is
+ * delta-filtered, in which case the stride follows as 1 byte). A Stored block continues with its
+ * original bytes. A Coded block continues with its code table (1 byte: a
+ * shared table index, or kOwnCode), the bit count of every stream (8 bytes
+ * each), 128 bytes of nibble-packed code lengths if the block has its own
+ * code, then the streams one after another, each padded to a whole byte.
+ * A RunLength block first stores the literal count (4 bytes) and run list
+ * size (4 bytes), then continues like a Coded block whose payload is the
+ * run list followed by the streams of the coded literals. The run list
+ * holds one (literals since the previous run, extra repeats) pair of LEB128
+ * varints per run. An Lz77 or Bwt block continues with its payload size
+ * (4 bytes) and the payload. A Context block continues with its table
+ * count (1 byte), the stream bit counts, the table of every previous byte
+ * value (128 bytes, nibble-packed), the code lengths of each table (128
+ * bytes each) and the streams, stream s coding segment s of the block.
+ * 
+ * Blocks built by the encoder own their payload; blocks parsed from a
+ * mapped archive point at the payload in place instead of copying it.
+ */
+struct ArchiveBlock {
+    static const unsigned kStreamCount = 4;   ///< Interleaved bitstreams per block
+    static const uint8_t kOwnCode = 0xFF;     ///< Code table value of a block storing its own lengths
+    
+    /// How the block's payload represents its data
+    enum Mode { Coded = 0, Stored = 1, RunLength = 2, Lz77 = 3, Bwt = 4, Context = 5 };
+    
+    /// Mode byte flag: the decoded bytes are delta-filtered (a stride byte follows)
+    static const uint8_t kDeltaFlag = 0x80;
+    
+    size_t originalSize;                 ///< Number of bytes the block decodes to
+    uint32_t checksum;                   ///< CRC-32C of the decoded block
+    uint8_t mode;                        ///< Coded, Stored, RunLength, Lz77, Bwt or Context
+    unsigned deltaStride;                ///< Stride of the delta filter to undo after decoding (0 = none)
+    uint8_t codeTable;                   ///< Shared code table used, or kOwnCode (Coded and RunLength blocks)
+    size_t literalCount;                 ///< Number of coded bytes (originalSize unless RunLength)
+    size_t runListSize;                  ///< Bytes of run list at the start of the payload (RunLength)
+    size_t packedSize;                   ///< Size of the payload in bytes (Lz77 and Bwt)
+    unsigned tableCount;                 ///< Number of context code tables (Context)
+    uint8_t tableOf[256];                ///< Context code table used after each byte value (Context)
+    std::vector<uint8_t> contextLengths; ///< tableCount tables of 256 code lengths (Context)
+    size_t streamBits[kStreamCount];     ///< Number of valid bits in each stream (excluding padding)
+    uint8_t codeLengths[256];            ///< Canonical code length per byte value (0 = unused)
+    std::vector<unsigned char> payload;  ///< Packed or stored data owned by the block
+    const unsigned char* mappedPayload;  ///< Packed or stored data inside an archive buffer (nullptr if owned)
+    
+    /**
+     * @brief Default constructor
+     * 
+     * Initializes sizes and code lengths to zero; the block is Coded with its own code.
+     */
+    ArchiveBlock();
+    
+    /**
+     * @brief Write the block to an output stream
+     * 
+     * @param out Stream positioned where the block should be stored
+     */
+    void writeTo(std::ostream& out) const;
+    
+    /**
+     * @brief Append the block to an archive buffer
+     * 
+     * Used for the blocks nested inside an LZ77 payload.
+     * 
+     * @param out Buffer receiving the block
+     */
+    void writeTo(ArchiveWriter& out) const;
+    
+    /**
+     * @brief Get the packed payload, wherever it is stored
+     * @return const unsigned char* Start of the payload
+     */
+    const unsigned char* payloadData() const;
+    
+    /**
+     * @brief Get the size of the payload
+     * @return size_t Payload size in bytes, run list and all streams included (originalSize if Stored,
+     *         packedSize if Lz77 or Bwt)
+     */
+    size_t payloadSize() const;
+    
+    /**
+     * @brief Get the size of one stream
+     * @param stream Stream number, below kStreamCount
+     * @return size_t Stream size in bytes, padding included
+     */
+    size_t streamSize(unsigned stream) const;
+    
+    /**
+     * @brief Get the number of valid payload bits over all streams
+     * @return size_t Total bit count (excluding padding; 8 per payload byte if Stored, Lz77 or Bwt)
+     */
+    size_t totalBits() const;
+    
+    /**
+     * @brief Parse a block previously written by writeTo() without copying its payload
+     * 
+     * The returned block references the reader's buffer, which must outlive it.
+     * A block using a shared code gets its code lengths from sharedCodes.
+     * 
+     * @param reader Cursor positioned at the start of a block
+     * @param maxOriginalSize Largest decoded size accepted for the block
+     * @param sharedCodes Code tables of the archive holding the block
+     * @return ArchiveBlock The block, with mappedPayload pointing into the buffer
+     * @throws HuffmanException If the block is truncated, its sizes are implausible
+     *         or it refers to a missing code table
+     */
+    static ArchiveBlock parse(ArchiveReader& reader, size_t maxOriginalSize, 
+                              const SharedCodeTables& sharedCodes);
+};
@@ -0,0 +1,173 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief MSB-first bit writer backed by a packed byte buffer
+ *
+ * Collects variable-length codes in a 64-bit accumulator and spills them
+ * to the output buffer 32 bits at a time. The first bit written ends up in
+ * the most significant bit of the first byte, matching the bit order used
+ * by the archive format. The final byte is padded with zero bits.
+ */
+class BitWriter {
+private:
+    std::vector<unsigned char> bytes;  ///< Packed output buffer (may be larger than used)
+    size_t bytePos;                    ///< Number of bytes already committed to the buffer
+    uint64_t accumulator;              ///< Pending bits, right-aligned in the low bits
+    unsigned pendingBits;              ///< Number of valid bits held in the accumulator
+    size_t totalBits;                  ///< Total number of bits written so far
+
+    /**
+     * @brief Make sure at least @p count more bytes fit into the buffer
+     * @param count Number of bytes about to be written
+     */
+    void ensureCapacity(size_t count);
+
+public:
+    /**
+     * @brief Construct a new Bit Writer
+     *
+     * @param expectedBytes Optional size hint used to preallocate the output buffer
+     */
+    explicit BitWriter(size_t expectedBytes = 0);
+
+    /**
+     * @brief Append the low @p length bits of @p code, most significant bit first
+     *
+     * @param code Code value, right-aligned
+     * @param length Number of bits to write (0-64)
+     */
+    inline void writeBits(uint64_t code, unsigned length)
+    {
+        if (length > 32)
+        {
+            writeBits(code >> 32, length - 32);
+            code &= 0xFFFFFFFFu;
+            length = 32;
+        }
+
+        accumulator = (accumulator << length) | code;
+        pendingBits += length;
+        totalBits += length;
+
+        if (pendingBits >= 32)
+        {
+            pendingBits -= 32;
+            uint32_t word = static_cast<uint32_t>(accumulator >> pendingBits);
+            ensureCapacity(4);
+            bytes[bytePos++] = static_cast<unsigned char>(word >> 24);
+            bytes[bytePos++] = static_cast<unsigned char>(word >> 16);
+            bytes[bytePos++] = static_cast<unsigned char>(word >> 8);
+            bytes[bytePos++] = static_cast<unsigned char>(word);
+        }
+    }
+
+    /**
+     * @brief Flush pending bits, padding the last byte with zeros
+     *
+     * Must be called once after the last writeBits() before the buffer is used.
+     */
+    void flush();
+
+    /**
+     * @brief Get the total number of bits written (excluding padding)
+     * @return size_t Number of valid bits
+     */
+    size_t getBitCount() const;
+
+    /**
+     * @brief Move the packed bytes out of the writer
+     *
+     * Flushes pending bits and returns the buffer trimmed to its used size.
+     * The bit count remains queryable afterwards.
+     *
+     * @return std::vector<unsigned char> Packed output bytes
+     */
+    std::vector<unsigned char> release();
+};
+
+/**
+ * @brief MSB-first bit reader over a packed byte buffer
+ *
+ * Keeps up to 64 upcoming bits left-aligned in a bit buffer so decoders can
+ * peek several bits at once and consume only as many as a code needs.
+ * Reads past the end of the buffer yield zero bits; callers compare
+ * getBitsConsumed() against the number of valid bits to detect overruns.
+ */
+class BitReader {
+private:
+    const unsigned char* data;  ///< Start of the packed input
+    size_t size;                ///< Number of bytes available in the input
+    size_t bytePos;             ///< Next byte to load into the bit buffer
+    uint64_t buffer;            ///< Upcoming bits, left-aligned
+    unsigned bitsInBuffer;      ///< Number of valid bits at the top of the buffer
+    size_t bitsConsumed;        ///< Total number of bits consumed so far
+
+public:
+    /**
+     * @brief Construct a new Bit Reader
+     *
+     * @param input Pointer to the packed input bytes
+     * @param inputSize Number of bytes in the input
+     */
+    BitReader(const unsigned char* input, size_t inputSize);
+
+    /**
+     * @brief Top up the bit buffer so that at least 56 bits can be peeked
+     */
+    inline void refill()
+    {
+        if (bytePos + 8 <= size)
+        {
+            // Branch-free refill: load 8 bytes, keep as many whole bytes as fit
+            const unsigned char* p = data + bytePos;
+            uint64_t word = (static_cast<uint64_t>(p[0]) << 56) | (static_cast<uint64_t>(p[1]) << 48) |
+                            (static_cast<uint64_t>(p[2]) << 40) | (static_cast<uint64_t>(p[3]) << 32) |
+                            (static_cast<uint64_t>(p[4]) << 24) | (static_cast<uint64_t>(p[5]) << 16) |
+                            (static_cast<uint64_t>(p[6]) << 8)  |  static_cast<uint64_t>(p[7]);
+            buffer |= word >> bitsInBuffer;
+            bytePos += (63 - bitsInBuffer) >> 3;
+            bitsInBuffer |= 56;
+        }
+        else
+        {
+            while (bitsInBuffer <= 56)
+            {
+                uint64_t byte = bytePos < size ? data[bytePos] : 0;
+                buffer |= byte << (56 - bitsInBuffer);
+                bytePos++;
+                bitsInBuffer += 8;
+            }
+        }
+    }
+
+    /**
+     * @brief Look at the next @p count bits without consuming them
+     *
+     * @param count Number of bits to peek (1-56, after refill())
+     * @return uint64_t The bits, right-aligned
+     */
+    inline uint64_t peek(unsigned count) const
+    {
+        return buffer >> (64 - count);
+    }
+
+    /**
+     * @brief Drop @p count bits from the front of the buffer
+     * @param count Number of bits to consume (must not exceed the buffered bits)
+     */
+    inline void consume(unsigned count)
+    {
+        buffer <<= count;
+        bitsInBuffer -= count;
+        bitsConsumed += count;
+    }
+
+    /**
+     * @brief Get the total number of bits consumed so far
+     * @return size_t Number of consumed bits
+     */
+    size_t getBitsConsumed() const;
+};
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Burrows-Wheeler front end of the high-ratio compression method
+ *
+ * A block is sorted with the Burrows-Wheeler transform (its suffix array
+ * built in linear time with SA-IS), which groups bytes by the context that
+ * follows them. Move-to-front then turns those groups into runs of small
+ * ranks, and runs of rank 0 are written as bijective base-2 digits (RUNA
+ * and RUNB, as in bzip2), leaving a byte stream that the regular block
+ * coder codes well. Each block is transformed on its own, so blocks keep
+ * being sorted in parallel on the encoder's thread pool.
+ *
+ * Symbols: 0 and 1 are the RUNA and RUNB digits of a zero-rank run, rank r
+ * from 1 to 254 is r + 1, and 255 stands for rank 254 or 255 with one extra
+ * bit telling which (only blocks using all 256 byte values need it).
+ *
+ * Payload layout: primary index (4 bytes, the row of the sorted matrix
+ * holding the original block), symbol count (4 bytes), the symbols as a
+ * nested block, then the extra-bits stream as a bit count (8 bytes) and
+ * its packed bytes.
+ */
+class Bwt {
+public:
+    /**
+     * @brief Build the suffix array of a text ending in a unique smallest symbol
+     *
+     * Uses SA-IS (induced sorting), which runs in time linear in the text
+     * length.
+     *
+     * @param text Pointer to the symbols; text[length - 1] must be smaller than all others
+     * @param suffixArray Output array of length entries: the start of each suffix in sorted order
+     * @param length Number of symbols, sentinel included (below 2^31)
+     * @param alphabetSize Number of distinct symbol values (all symbols are below it)
+     */
+    static void buildSuffixArray(const uint16_t* text, int32_t* suffixArray,
+                                 int32_t length, int32_t alphabetSize);
+
+    /**
+     * @brief Compress one block into a BWT payload
+     *
+     * @param data Pointer to the block contents
+     * @param size Number of bytes in the block (below 2^31)
+     * @param maxCodeLength Longest Huffman code allowed in the nested block
+     * @return std::vector<unsigned char> The payload
+     */
+    static std::vector<unsigned char> compress(const unsigned char* data, size_t size, unsigned maxCodeLength);
+
+    /**
+     * @brief Decompress a BWT payload
+     *
+     * @param payload Pointer to the payload
+     * @param payloadSize Payload size in bytes
+     * @param out Output buffer receiving exactly outSize bytes
+     * @param outSize Number of bytes the payload decodes to
+     * @throws HuffmanException If the payload is corrupted or does not decode to outSize bytes
+     */
+    static void decompress(const unsigned char* payload, size_t payloadSize,
+                           unsigned char* out, size_t outSize);
+
+    /**
+     * @brief Describe the method for the archive metadata
+     * @return std::string "BWT+MTF+Huffman"
+     */
+    static std::string describe();
+};
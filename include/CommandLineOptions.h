@@ -1,5 +1,6 @@
 #pragma once
 #include "OperationMode.h"
+#include "CompressionMethod.h"
 #include "HuffmanException.h"
 #include <iostream>
 #include <string>
@@ -13,13 +14,35 @@
  * validates the parsed options and throws appropriate exceptions for invalid input.
  */
 class CommandLineOptions {
+public:
+    static const size_t kDefaultBlockSize = 1 << 20;   ///< Default block size (1 MiB)
+    static const size_t kMinBlockSize = 1 << 10;       ///< Smallest accepted block size (1 KiB)
+    static const size_t kMaxBlockSize = 1 << 30;       ///< Largest accepted block size (1 GiB)
+    static const size_t kMaxThreads = 256;             ///< Largest accepted worker thread count
+    static const unsigned kMinCodeLengthLimit = 11;    ///< Smallest accepted maximum code length
+    static const unsigned kMaxCodeLengthLimit = 15;    ///< Largest accepted maximum code length (default)
+    static const size_t kMaxShards = 1 << 16;          ///< Largest accepted shard count
+
 private:
     // Flags for different operations
-    OperationMode mode;           ///< The operation mode (encode, decode, info)
+    OperationMode mode;           ///< The operation mode (encode, decode, extract, test, info, frequencies)
     bool recursive;               ///< Whether to operate recursively on directories
     bool verbose;                 ///< Whether to display verbose output
     std::string outputFile;       ///< Output file path for encoding operations
     std::vector<std::string> inputFiles; ///< List of input files or directories
+    size_t blockSize;             ///< Uncompressed bytes per archive block (encode only)
+    size_t threadCount;           ///< Number of worker threads for block processing
+    unsigned maxCodeLength;       ///< Longest Huffman code allowed in bits (encode only)
+    size_t shardIndex;            ///< Which shard of the inputs to process (encode/frequencies)
+    size_t shardCount;            ///< Number of shards the inputs are split into (1 = all input)
+    std::string codeTableFile;    ///< Frequency table giving a code shared by all blocks (encode only)
+    bool runLength;               ///< Whether blocks may code long byte runs separately (encode only)
+    bool order1;                  ///< Whether blocks may use order-1 context code tables (encode only)
+    unsigned deltaStride;         ///< Delta filter stride, DeltaFilter::kAutoStride to detect, 0 = off (encode only)
+    CompressionMethod method;     ///< How blocks are coded (encode only)
+    bool methodSpecified;         ///< Whether -m/--method was given
+    unsigned level;               ///< LZ77 effort level (--method lz77 only)
+    size_t windowSize;            ///< LZ77 window in bytes (--method lz77 only)
 
 public:
     /**
@@ -35,7 +58,7 @@ public:
 
     /**
      * @brief Get the operation mode
-     * @return OperationMode The parsed operation mode (Encode, Decode, or Info)
+     * @return OperationMode The parsed operation mode (Encode, Decode, Extract, Test, Info, or Frequencies)
      */
     OperationMode getMode() const;
     
@@ -62,6 +85,78 @@ public:
      * @return const std::vector<std::string>& Vector of input file/directory paths
      */
     const std::vector<std::string>& getInputFiles() const;
+    
+    /**
+     * @brief Get the archive block size
+     * @return size_t Uncompressed bytes per block, set with -b/--block-size (default 1 MiB)
+     */
+    size_t getBlockSize() const;
+    
+    /**
+     * @brief Get the number of worker threads
+     * @return size_t Thread count set with -j/--threads (default 1)
+     */
+    size_t getThreadCount() const;
+    
+    /**
+     * @brief Get the maximum Huffman code length
+     * @return unsigned Code length limit in bits, set with --max-code-len (default 15)
+     */
+    unsigned getMaxCodeLength() const;
+    
+    /**
+     * @brief Get the shard of the inputs to process
+     * @return size_t Zero-based shard index, set with --shard I/N (default 0)
+     */
+    size_t getShardIndex() const;
+    
+    /**
+     * @brief Get the number of shards the inputs are split into
+     * @return size_t Shard count, set with --shard I/N (default 1)
+     */
+    size_t getShardCount() const;
+    
+    /**
+     * @brief Get the frequency table that defines a shared code
+     * @return const std::string& Table file set with --code-from (empty for per-block codes)
+     */
+    const std::string& getCodeTableFile() const;
+    
+    /**
+     * @brief Check if the run-length stage is enabled
+     * @return bool True if --rle was specified
+     */
+    bool isRunLengthEnabled() const;
+    
+    /**
+     * @brief Check if order-1 context tables are enabled
+     * @return bool True if --order1 was specified
+     */
+    bool isOrder1Enabled() const;
+    
+    /**
+     * @brief Get the delta filter stride
+     * @return unsigned Stride set with --delta, DeltaFilter::kAutoStride for auto, 0 if off
+     */
+    unsigned getDeltaStride() const;
+    
+    /**
+     * @brief Get the compression method
+     * @return CompressionMethod Method set with -m/--method (default Huffman)
+     */
+    CompressionMethod getMethod() const;
+    
+    /**
+     * @brief Get the LZ77 effort level
+     * @return unsigned Level set with --level, 1 to 9 (default 5)
+     */
+    unsigned getLevel() const;
+    
+    /**
+     * @brief Get the LZ77 window size
+     * @return size_t Window in bytes set with --window (default 256 KiB)
+     */
+    size_t getWindowSize() const;
 
     /**
      * @brief Print usage information to stdout
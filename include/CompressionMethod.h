@@ -0,0 +1,36 @@
+#pragma once
+
+/**
+ * @brief Enumeration of the compression methods an archive can be written with
+ *
+ * The method decides how the encoder codes every block; the decoder needs
+ * no setting, since each block records how it was coded.
+ */
+enum class CompressionMethod {
+    /**
+     * @brief Order-0 Huffman coding of the block bytes
+     *
+     * The default: fast in both directions, with each block coded by its
+     * own or a shared canonical code (or stored, or run-length coded).
+     */
+    Huffman,
+
+    /**
+     * @brief LZ77 matching followed by Huffman coding
+     *
+     * Replaces repeated strings by (length, distance) matches found with a
+     * hash-chain match finder, then Huffman-codes the literals, lengths and
+     * distances. Much higher ratios on text, logs and JSON at a higher
+     * encoding cost; --level and --window trade speed for ratio.
+     */
+    Lz77,
+
+    /**
+     * @brief Burrows-Wheeler transform, move-to-front and Huffman coding
+     *
+     * Sorts each block by context (bzip2 style) before coding. The highest
+     * ratios on text, at the cost of several times the encode and decode
+     * time and about 7 bytes of memory per block byte while sorting.
+     */
+    Bwt
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Order-1 context model: code tables selected by the previous byte
+ *
+ * Text and source code are far more predictable from the previous byte
+ * than from the byte histogram alone, but a code table per previous byte
+ * would cost more to store than it saves. The model clusters the 256
+ * previous-byte contexts of a block into at most kMaxTables groups with
+ * similar next-byte statistics and builds one canonical code per group.
+ *
+ * The block is split into kStreamCount contiguous segments, one bitstream
+ * each, so that every stream knows its own previous byte and the decoder
+ * can still advance all streams at once. The first byte of each segment
+ * uses context 0.
+ */
+struct ContextModel {
+    static const unsigned kMaxTables = 16;     ///< Most code tables per block
+    static const unsigned kStreamCount = 4;    ///< Bitstreams (segments) per block
+    static const size_t kMinBlockSize = 4096;  ///< Smaller blocks are not worth modelling
+
+    unsigned tableCount;                ///< Number of code tables
+    uint8_t tableOf[256];               ///< Code table used after each byte value
+    std::vector<uint8_t> codeLengths;   ///< tableCount tables of 256 code lengths
+    uint64_t codedBits;                 ///< Estimated payload bits, tables and context map included
+
+    /**
+     * @brief Default constructor
+     *
+     * Creates an empty model whose estimated size is UINT64_MAX.
+     */
+    ContextModel();
+
+    /**
+     * @brief Cluster the contexts of a block and build their codes
+     *
+     * Contexts are assigned to the codes of the most frequent contexts,
+     * refined by reassigning each context to its cheapest code, then
+     * clusters are merged while a merge saves more than the table it
+     * removes.
+     *
+     * @param data Pointer to the block contents
+     * @param size Number of bytes in the block
+     * @param maxCodeLength Longest code allowed in bits
+     * @return ContextModel The model (empty if the block is below kMinBlockSize)
+     */
+    static ContextModel build(const unsigned char* data, size_t size, unsigned maxCodeLength);
+
+    /**
+     * @brief Get the bytes of the block coded by one stream
+     *
+     * @param size Number of bytes in the block
+     * @param stream Stream number, below kStreamCount
+     * @param begin Output: offset of the segment's first byte
+     * @param end Output: offset one past the segment's last byte
+     */
+    static void segment(size_t size, unsigned stream, size_t& begin, size_t& end);
+
+    /**
+     * @brief Code a block with the model
+     *
+     * @param data Pointer to the block contents
+     * @param size Number of bytes in the block
+     * @param outStreamBits Output: number of valid bits in each stream
+     * @return std::vector<unsigned char> The streams one after another, each padded to a whole byte
+     */
+    std::vector<unsigned char> encode(const unsigned char* data, size_t size,
+                                      size_t outStreamBits[kStreamCount]) const;
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief CRC-32C (Castagnoli) checksums
+ *
+ * Computes the CRC-32C used for archive integrity checks. On x86 CPUs with
+ * SSE4.2 the dedicated crc32 instruction is used, eight bytes at a time;
+ * elsewhere a portable slicing-by-8 table implementation gives the same
+ * results. The implementation is chosen once, at first use.
+ */
+class Crc32c {
+public:
+    /**
+     * @brief Compute the CRC-32C of a buffer
+     *
+     * @param data Pointer to the bytes
+     * @param size Number of bytes
+     * @return uint32_t The checksum (0 for an empty buffer)
+     */
+    static uint32_t compute(const unsigned char* data, size_t size);
+
+    /**
+     * @brief Extend a checksum with more data
+     *
+     * extend(compute(a), b) equals the checksum of a followed by b.
+     *
+     * @param crc Checksum of the preceding data
+     * @param data Pointer to the following bytes
+     * @param size Number of following bytes
+     * @return uint32_t Checksum of the combined data
+     */
+    static uint32_t extend(uint32_t crc, const unsigned char* data, size_t size);
+
+    /**
+     * @brief Combine the checksums of two adjacent pieces of data
+     *
+     * Gives the checksum of A followed by B from the checksums of A and B
+     * alone, so pieces checksummed independently (e.g. blocks on different
+     * threads) yield the checksum of the whole.
+     *
+     * @param crcA Checksum of the first piece
+     * @param crcB Checksum of the second piece
+     * @param sizeB Length of the second piece in bytes
+     * @return uint32_t Checksum of both pieces in order
+     */
+    static uint32_t combine(uint32_t crcA, uint32_t crcB, uint64_t sizeB);
+
+    /**
+     * @brief Check whether checksums use the CPU's crc32 instruction
+     * @return bool True if the SSE4.2 implementation is in use
+     */
+    static bool isHardwareAccelerated();
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Per-lane delta filter for arrays of fixed-size numbers
+ *
+ * Arrays of little-endian integers or floats have a nearly flat byte
+ * histogram, but neighbouring values are close: replacing every byte by
+ * its difference (modulo 256) from the byte one stride earlier, that is
+ * the same byte of the previous element, leaves mostly small residuals
+ * that Huffman coding compresses well. The first stride bytes are kept
+ * as they are. Lanes are filtered independently without carries, so the
+ * filter works the same for integers of any width and for floats.
+ */
+class DeltaFilter {
+public:
+    static const unsigned kMaxStride = 32;            ///< Largest accepted stride in bytes
+    static const unsigned kAutoStride = kMaxStride + 1;   ///< Stride value asking for detection per block
+    static const size_t kSampleSize = 64 * 1024;      ///< Bytes of a block examined by chooseStride()
+
+    /**
+     * @brief Filter a buffer
+     *
+     * @param data Pointer to the original bytes
+     * @param size Number of bytes
+     * @param stride Distance in bytes between corresponding bytes, 1 to kMaxStride
+     * @param out Output buffer receiving size filtered bytes (must not overlap data)
+     */
+    static void encode(const unsigned char* data, size_t size, unsigned stride, unsigned char* out);
+
+    /**
+     * @brief Undo the filter in place
+     *
+     * @param data Pointer to the filtered bytes, replaced by the original bytes
+     * @param size Number of bytes
+     * @param stride Stride the data was filtered with
+     */
+    static void decode(unsigned char* data, size_t size, unsigned stride);
+
+    /**
+     * @brief Pick the stride that makes a block most compressible
+     *
+     * Compares the order-0 entropy of samples spread over the block, as
+     * they are and filtered with every candidate stride.
+     *
+     * @param data Pointer to the block contents
+     * @param size Number of bytes in the block
+     * @param requested Stride to check, or kAutoStride to try 1 to kMaxStride
+     * @return unsigned The best stride, or 0 if filtering saves less than 1/32
+     */
+    static unsigned chooseStride(const unsigned char* data, size_t size, unsigned requested);
+};
@@ -0,0 +1,87 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Byte frequency counts that can be saved and merged
+ *
+ * Holds one 64-bit count per byte value. Tables counted over separate
+ * pieces of input (for example by different worker processes) can be
+ * merged into the table of the whole input, so independently compressed
+ * shards can all use the code derived from the global frequencies.
+ *
+ * On disk a table is stored as the magic number "HFT" 0x1A, a 2-byte
+ * version, 2 reserved bytes and 256 little-endian 8-byte counts.
+ */
+class FrequencyTable {
+public:
+    static const unsigned char kMagic[4];   ///< "HFT" followed by 0x1A
+    static const uint16_t kVersion = 1;     ///< File format version
+    static const size_t kFileSize = 8 + 256 * 8;   ///< Size of a table file in bytes
+
+private:
+    uint64_t counts[256];   ///< Occurrences of every byte value
+
+public:
+    /**
+     * @brief Construct an empty table
+     */
+    FrequencyTable();
+
+    /**
+     * @brief Add counts collected elsewhere
+     * @param counts Array of 256 counts indexed by byte value
+     */
+    void add(const uint64_t counts[256]);
+
+    /**
+     * @brief Add the counts of another table
+     * @param other Table to merge into this one
+     */
+    void merge(const FrequencyTable& other);
+
+    /**
+     * @brief Get the count of one byte value
+     * @param symbol Byte value
+     * @return uint64_t Number of occurrences
+     */
+    uint64_t count(unsigned char symbol) const;
+
+    /**
+     * @brief Get all counts
+     * @return const uint64_t* Array of 256 counts indexed by byte value
+     */
+    const uint64_t* data() const;
+
+    /**
+     * @brief Get the number of bytes counted
+     * @return uint64_t Sum of all counts
+     */
+    uint64_t total() const;
+
+    /**
+     * @brief Save the table to a file
+     *
+     * @param path Destination file
+     * @throws HuffmanException If the file cannot be written
+     */
+    void save(const std::string& path) const;
+
+    /**
+     * @brief Load a table saved by save()
+     *
+     * @param path Source file
+     * @return FrequencyTable The table
+     * @throws HuffmanException If the file cannot be read or is not a table
+     */
+    static FrequencyTable load(const std::string& path);
+
+    /**
+     * @brief Check whether a file starts with the table magic number
+     *
+     * @param path File to check
+     * @return bool True if the file looks like a saved frequency table
+     */
+    static bool isTableFile(const std::string& path);
+};
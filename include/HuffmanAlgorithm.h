@@ -1,6 +1,9 @@
 #pragma once
-#include "HuffmanNode.h"
+#include "HuffmanCodeTable.h"
 #include "ArchiveStructures.h"
+#include "Lz77.h"
+#include "Bwt.h"
+#include "ContextModel.h"
 #include "CommandLineOptions.h"
 #include "OperationMode.h"
 #include "HuffmanException.h"
@@ -13,8 +16,10 @@
  * @brief Core Huffman compression algorithm implementation
  * 
  * This class contains all the main algorithms for Huffman compression
- * including frequency analysis, tree construction, code generation,
- * and text encoding/decoding operations.
+ * including frequency analysis, block coding and decoding, and the
+ * archive-level encode, decode, extract and inspection operations. Codes
+ * are canonical and built from code lengths (HuffmanCodeTable), so no
+ * Huffman tree is ever built.
  */
 class HuffmanAlgorithm
 {
@@ -23,7 +28,6 @@ public:
      * @brief Build character frequency table from input text
      * 
      * Analyzes the input text and counts the frequency of each character.
-     * This frequency table is used to construct the optimal Huffman tree.
      * 
      * @param text The input text to analyze
      * @return std::map<char, int> Map of characters to their frequencies
@@ -31,54 +35,42 @@ public:
     static std::map<char, int> buildFrequencyTable(const std::string& text);
     
     /**
-     * @brief Build Huffman tree from character frequencies
+     * @brief Build character frequency table from a raw byte range
      * 
-     * Constructs the optimal Huffman tree using a priority queue algorithm.
-     * The tree is built bottom-up by repeatedly combining the two nodes
-     * with the lowest frequencies.
-     * 
-     * @param frequencies Map of characters to their frequencies
-     * @return HuffmanNode* Pointer to the root of the constructed tree
-     */
-    static HuffmanNode* buildHuffmanTree(const std::map<char, int>& frequencies);
-    
-    /**
-     * @brief Generate Huffman codes from the tree
-     * 
-     * Traverses the Huffman tree to generate the optimal binary codes
-     * for each character. Left edges represent '0' and right edges '1'.
-     * 
-     * @param root Pointer to the root of the Huffman tree
-     * @param code Current code being built (used for recursion)
-     * @param codes Output map to store character-to-code mappings
+     * @param data Pointer to the bytes to analyze (e.g. a memory-mapped file)
+     * @param size Number of bytes to analyze
+     * @return std::map<char, int> Map of characters to their frequencies
      */
-    static void generateCodes(HuffmanNode* root, const std::string& code, 
-                             std::map<char, std::string>& codes);
+    static std::map<char, int> buildFrequencyTable(const unsigned char* data, size_t size);
     
     /**
-     * @brief Encode text using Huffman codes
+     * @brief Count byte occurrences into a flat histogram
      * 
-     * Converts input text to a compressed binary string using the
-     * provided Huffman codes for each character.
+     * Branch-free counting kernel behind buildFrequencyTable(). Bytes are
+     * spread over several interleaved sub-histograms so runs of the same
+     * byte do not serialize on a single counter's store-to-load dependency.
      * 
-     * @param text The text to encode
-     * @param codes Map of characters to their Huffman codes
-     * @return std::string The encoded binary string
+     * @param data Pointer to the bytes to count
+     * @param size Number of bytes to count
+     * @param counts Histogram the occurrences are added to
      */
-    static std::string encodeText(const std::string& text, 
-                                 const std::map<char, std::string>& codes);
+    static void countByteFrequencies(const unsigned char* data, size_t size, uint64_t counts[256]);
     
     /**
-     * @brief Decode binary string using Huffman tree
+     * @brief Encode a raw byte range into interleaved bitstreams
      * 
-     * Converts a Huffman-encoded binary string back to the original text
-     * by traversing the Huffman tree according to the binary digits.
+     * Byte i is coded into stream i % ArchiveBlock::kStreamCount; the
+     * streams are stored one after another, each padded to a whole byte.
      * 
-     * @param encodedText The binary string to decode
-     * @param root Pointer to the root of the Huffman tree
-     * @return std::string The decoded original text
+     * @param data Pointer to the bytes to encode
+     * @param size Number of bytes to encode
+     * @param table Packed code table for every byte value
+     * @param outStreamBits Output parameter for the valid bit count of each stream
+     * @return std::vector<unsigned char> The concatenated streams
      */
-    static std::string decodeText(const std::string& encodedText, HuffmanNode* root);
+    static std::vector<unsigned char> encodeInterleaved(const unsigned char* data, size_t size,
+                                                       const HuffmanCodeTable& table,
+                                                       size_t outStreamBits[ArchiveBlock::kStreamCount]);
     
     /**
      * @brief Calculate Shannon entropy for frequency distribution
@@ -95,50 +87,81 @@ public:
                                          int totalChars);
     
     /**
-     * @brief Generate complete compression statistics
-     * 
-     * Analyzes text and generates comprehensive statistics including
-     * character frequencies, Huffman codes, compression ratios,
-     * and efficiency metrics.
+     * @brief Generate complete compression statistics for a raw byte range
      * 
-     * @param text The input text to analyze
+     * @param data Pointer to the bytes to analyze
+     * @param size Number of bytes to analyze
+     * @param maxCodeLength Longest code allowed in the generated codes
      * @return CompressionStatistics Complete statistical analysis
      */
-    static CompressionStatistics generateCompressionStatistics(const std::string& text);
+    static CompressionStatistics generateCompressionStatistics(const unsigned char* data, size_t size,
+                                                               unsigned maxCodeLength = HuffmanCodeTable::kMaxCodeLength);
     
     /**
-     * @brief Perform complete Huffman compression
-     * 
-     * High-level function that performs the complete compression process:
-     * frequency analysis, tree building, code generation, and text encoding.
-     * 
-     * @param text The text to compress
-     * @param outTree Output parameter for the constructed Huffman tree
-     * @param outStats Output parameter for compression statistics
-     * @return std::string The compressed binary string
+     * @brief Compress one archive block
+     * 
+     * Builds a code table for the block alone and encodes it into interleaved
+     * streams. Given a shared code, the block uses that code instead when the
+     * estimated payload is no larger than with its own code plus the 128
+     * bytes its own code lengths would take; a block containing a byte the
+     * shared code lacks always uses its own code. A block whose coded size
+     * would save less than 1/32 of its size is stored verbatim instead.
+     * With runLength set, runs of 32 or more equal bytes may be cut out and
+     * listed separately, coding only the remaining literals, when that is
+     * smaller. Given LZ77 parameters, the block is first parsed into LZ77
+     * matches and coded that way when the result is smaller still; with bwt
+     * set, the Burrows-Wheeler payload is tried the same way. With order1
+     * set, coding with order-1 context tables (ContextModel) replaces the
+     * single code when its estimate is smaller. Given a delta stride, the
+     * block is delta-filtered first if that makes it clearly more
+     * compressible (see DeltaFilter).
+     * 
+     * @param data Pointer to the uncompressed block contents
+     * @param size Number of bytes in the block
+     * @param outStats Output parameter for the block's compression statistics
+     * @param maxCodeLength Longest code allowed in bits (--max-code-len)
+     * @param sharedCodeLengths Code lengths of a shared code, or nullptr for a per-block code
+     * @param sharedCodeIndex Index of the shared code in the archive's code tables
+     * @param runLength Whether to consider the run-length stage (--rle)
+     * @param lz77 LZ77 match finder settings (--method lz77), or nullptr for Huffman coding only
+     * @param bwt Whether to try the Burrows-Wheeler transform (--method bwt)
+     * @param order1 Whether to try order-1 context tables (--order1)
+     * @param deltaStride Delta filter stride to try (--delta), DeltaFilter::kAutoStride to detect it, 0 for none
+     * @return ArchiveBlock The coded block with its code lengths and code table
      */
-    static std::string compressText(const std::string& text, 
-                                   HuffmanNode*& outTree, 
-                                   CompressionStatistics& outStats);
+    static ArchiveBlock compressBlock(const unsigned char* data, size_t size, 
+                                      CompressionStatistics& outStats,
+                                      unsigned maxCodeLength = HuffmanCodeTable::kMaxCodeLength,
+                                      const uint8_t* sharedCodeLengths = nullptr,
+                                      uint8_t sharedCodeIndex = 0,
+                                      bool runLength = false,
+                                      const Lz77::Parameters* lz77 = nullptr,
+                                      bool bwt = false,
+                                      bool order1 = false,
+                                      unsigned deltaStride = 0);
     
     /**
-     * @brief Perform complete Huffman decompression
+     * @brief Decompress one archive block
      * 
-     * High-level function that decompresses a Huffman-encoded binary string
-     * back to the original text using the provided Huffman tree.
+     * Stored blocks are copied as they are; the runs of RunLength blocks are
+     * expanded with memset after their literals are decoded, and Lz77 and
+     * Bwt blocks are handed to Lz77::decompress() and Bwt::decompress().
+     * Context blocks switch code tables by the previous byte. A
+     * delta-filtered block is unfiltered in place afterwards.
      * 
-     * @param encodedText The compressed binary string
-     * @param tree The Huffman tree used for encoding
-     * @return std::string The decompressed original text
+     * @param block The coded or stored block as read from the archive
+     * @param out Output buffer receiving block.originalSize bytes
+     * @throws HuffmanException If the block's code table or payload is corrupted
      */
-    static std::string decompressText(const std::string& encodedText, 
-                                     HuffmanNode* tree);
+    static void decompressBlock(const ArchiveBlock& block, unsigned char* out);
 
     /**
      * @brief Encode files based on command line options
      * 
      * High-level function that handles the complete encoding process including
-     * reading input files, performing compression, and writing output.
+     * reading input files, performing compression, and writing output. Inputs
+     * are memory-mapped where possible and blocks are compressed straight from
+     * the mapping; memory use does not grow with the archive size.
      * 
      * @param options Command line options containing input files and settings
      * @return bool True if encoding was successful, false otherwise
@@ -149,13 +172,52 @@ public:
      * @brief Decode archive based on command line options
      * 
      * High-level function that handles the complete decoding process including
-     * reading archive, decompressing data, and writing output files.
+     * reading archive, decompressing data, and writing output files. Blocks are
+     * decoded one at a time and written out as soon as they are decoded.
      * 
      * @param options Command line options containing input archive and settings
      * @return bool True if decoding was successful, false otherwise
      */
     static bool decodeArchive(const CommandLineOptions& options);
 
+    /**
+     * @brief Extract selected files from an archive
+     * 
+     * The first input is the archive and the remaining inputs name the
+     * members to restore. Each member is located through the archive's file
+     * index and only its own blocks are decoded; the rest of the archive is
+     * never read.
+     * 
+     * @param options Command line options containing the archive, member names and settings
+     * @return bool True if every requested member was extracted, false otherwise
+     */
+    static bool extractFiles(const CommandLineOptions& options);
+
+    /**
+     * @brief Verify an archive without writing any files
+     * 
+     * Decodes every block (in parallel with -j) and checks the CRC-32C of
+     * each block and each file, then reports the verified size and the
+     * throughput. Nothing is written to disk.
+     * 
+     * @param options Command line options containing the archive and settings
+     * @return bool True if every checksum matched, false otherwise
+     */
+    static bool testArchive(const CommandLineOptions& options);
+
+    /**
+     * @brief Count byte frequencies into a table file
+     * 
+     * Counts the input files (or the selected shard of them) and merges any
+     * frequency table files among the inputs, then saves the total to the
+     * output file. Tables from all shards merge into the global table that
+     * --code-from turns into a code shared by every shard.
+     * 
+     * @param options Command line options containing inputs, shard and output file
+     * @return bool True if the table was written, false otherwise
+     */
+    static bool countFrequencies(const CommandLineOptions& options);
+
     /**
      * @brief Display archive information based on command line options
      * 
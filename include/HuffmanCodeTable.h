@@ -0,0 +1,95 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+
+/**
+ * @brief Flat per-byte Huffman code table used by the bit-level encoder
+ *
+ * Stores the code of every byte value as a right-aligned integer plus its
+ * length in bits, so encoding a symbol is a single indexed load instead of
+ * a map lookup and string append. A length of zero marks an unused symbol.
+ */
+struct HuffmanCodeTable {
+    static const unsigned kMaxCodeLength = 15;  ///< Longest code storable in a 4-bit length field
+
+    uint64_t codes[256];    ///< Code bits for each byte value, right-aligned
+    uint8_t lengths[256];   ///< Code length in bits for each byte value (0 = unused)
+
+    /**
+     * @brief Default constructor
+     *
+     * Initializes all codes and lengths to zero.
+     */
+    HuffmanCodeTable();
+
+    /**
+     * @brief Build a code table from textual '0'/'1' codes
+     *
+     * @param codes Map of characters to their Huffman codes as produced by generateCodes()
+     * @return HuffmanCodeTable Table holding the same codes in packed form
+     */
+    static HuffmanCodeTable fromCodeStrings(const std::map<char, std::string>& codes);
+    
+    /**
+     * @brief Build a canonical code table from per-symbol code lengths
+     * 
+     * Assigns canonical Huffman codes: symbols are ordered by (length, byte
+     * value) and receive consecutive code values, so encoder and decoder
+     * derive identical codes from the lengths alone.
+     * 
+     * @param lengths Code length in bits for each byte value (0 = unused)
+     * @return HuffmanCodeTable Table holding the canonical codes
+     * @throws HuffmanException If the lengths violate the Kraft inequality
+     */
+    static HuffmanCodeTable fromCodeLengths(const uint8_t lengths[256]);
+    
+    /**
+     * @brief Build a length-limited canonical code table from byte counts
+     * 
+     * Computes optimal code lengths with computeCodeLengths(), limits them
+     * with limitCodeLengths() and assigns canonical codes. Allocates
+     * nothing unless the limit has to be enforced, so every block of an
+     * archive can rebuild its code cheaply.
+     * 
+     * @param frequencies Occurrence count for each byte value (0 = unused)
+     * @param maxLength Longest code allowed, at most kMaxCodeLength
+     * @return HuffmanCodeTable Canonical code table
+     */
+    static HuffmanCodeTable fromFrequencies(const uint64_t frequencies[256], unsigned maxLength);
+    
+    /**
+     * @brief Compute optimal (unlimited) Huffman code lengths in linear time
+     * 
+     * Sorts the used symbols by count once and runs the in-place algorithm
+     * of Moffat and Katajainen over that array: no tree nodes are created
+     * and no memory is allocated. A lone symbol gets a 1-bit code.
+     * 
+     * @param frequencies Occurrence count for each byte value (0 = unused)
+     * @param lengths Output code length for each byte value (0 = unused)
+     */
+    static void computeCodeLengths(const uint64_t frequencies[256], uint8_t lengths[256]);
+    
+    /**
+     * @brief Shorten code lengths so that none exceeds @p maxLength
+     * 
+     * Lengths that already fit are left untouched. Otherwise the lengths of
+     * the used symbols are recomputed with the package-merge algorithm,
+     * which yields the optimal prefix code among those limited to
+     * @p maxLength bits.
+     * 
+     * @param lengths Code lengths to adjust in place (0 = unused)
+     * @param frequencies Occurrence count for each byte value
+     * @param maxLength Maximum allowed code length in bits
+     * @throws HuffmanException If the used symbols cannot fit in @p maxLength bits
+     */
+    static void limitCodeLengths(uint8_t lengths[256], const uint64_t frequencies[256], 
+                                 unsigned maxLength);
+    
+    /**
+     * @brief Convert the table back to textual '0'/'1' codes
+     * 
+     * @return std::map<char, std::string> Map of used characters to their codes
+     */
+    std::map<char, std::string> toCodeStrings() const;
+};
@@ -0,0 +1,109 @@
+#pragma once
+#include "HuffmanCodeTable.h"
+#include "HuffmanException.h"
+#include "BitStream.h"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Table-driven single-lookup Huffman decoder
+ *
+ * Decodes packed MSB-first Huffman data without walking a tree. Codes are
+ * at most HuffmanCodeTable::kMaxCodeLength bits long, so one table indexed
+ * by the next (longest code length) bits resolves every symbol: the decoder
+ * peeks those bits, looks up a (symbol, length) entry and consumes only the
+ * length of the matched code. One 64-bit refill covers several symbols.
+ */
+class HuffmanDecoder {
+public:
+    /**
+     * @brief Build the decoding table for a code table
+     *
+     * @param table Packed code table as used by the encoder
+     * @param minTableBits Smallest index width of the table, so that decoders
+     *        switched between by decodeContexts() all peek the same number of bits
+     * @throws HuffmanException If a code is too long or the codes are not a valid prefix code
+     */
+    explicit HuffmanDecoder(const HuffmanCodeTable& table, unsigned minTableBits = 0);
+
+    /**
+     * @brief Decode a fixed number of symbols from packed data
+     *
+     * @param data Pointer to the packed input bytes
+     * @param size Number of bytes available at @p data
+     * @param totalBits Number of valid bits in the input (excluding padding)
+     * @param out Output buffer receiving @p count decoded bytes
+     * @param count Number of symbols to decode
+     * @return size_t Number of input bits consumed
+     * @throws HuffmanException If the data contains an invalid code or ends early
+     */
+    size_t decode(const unsigned char* data, size_t size, size_t totalBits,
+                  unsigned char* out, size_t count) const;
+
+    /**
+     * @brief Decode kInterleavedStreams bitstreams coded with the same table
+     *
+     * Output byte i comes from stream i % kInterleavedStreams. The streams
+     * are read by independent bit readers advanced in the same loop, so
+     * their lookups overlap instead of waiting on one another.
+     *
+     * @param data Start of each stream
+     * @param size Number of bytes available in each stream
+     * @param totalBits Number of valid bits in each stream (excluding padding)
+     * @param out Output buffer receiving @p count decoded bytes
+     * @param count Number of symbols to decode over all streams
+     * @throws HuffmanException If a stream contains an invalid code or ends early
+     */
+    void decodeInterleaved(const unsigned char* const data[], const size_t size[],
+                           const size_t totalBits[], unsigned char* out, size_t count) const;
+
+    /**
+     * @brief Decode a block coded with order-1 context tables
+     *
+     * Stream s holds segment s of the output (see ContextModel::segment()).
+     * Each symbol is decoded with the table of the byte before it in its
+     * segment: the table pointer is looked up from that byte, so switching
+     * tables costs one load and no branch.
+     *
+     * @param decoders One decoder per code table, all built with the same table width
+     * @param tableOf Code table used after each byte value
+     * @param data Start of each stream
+     * @param size Number of bytes available in each stream
+     * @param totalBits Number of valid bits in each stream (excluding padding)
+     * @param out Output buffer receiving @p count decoded bytes
+     * @param count Number of symbols to decode over all streams
+     * @throws HuffmanException If a stream contains an invalid code or ends early
+     */
+    static void decodeContexts(const std::vector<HuffmanDecoder>& decoders, const uint8_t tableOf[256],
+                               const unsigned char* const data[], const size_t size[],
+                               const size_t totalBits[], unsigned char* out, size_t count);
+
+    static const unsigned kInterleavedStreams = 4;   ///< Streams handled by decodeInterleaved()
+
+private:
+    /// Symbols decodable from one refill, which guarantees at least 56 bits
+    static const unsigned kSymbolsPerRefill = 56 / HuffmanCodeTable::kMaxCodeLength;
+
+    /**
+     * Table entries hold the symbol in the low byte and the code length in
+     * the high byte; length 0 marks a bit pattern no code uses.
+     */
+    std::vector<uint16_t> entries;
+    unsigned tableBits;   ///< Index width of the table (longest code length)
+
+    /**
+     * @brief Decode one symbol; the reader must hold at least tableBits bits
+     */
+    inline unsigned char decodeSymbol(BitReader& reader, const uint16_t* table) const
+    {
+        uint16_t entry = table[reader.peek(tableBits)];
+        unsigned length = entry >> 8;
+        if (length == 0)
+        {
+            throw HuffmanException::archiveFormatError("Invalid Huffman code in compressed data");
+        }
+        reader.consume(length);
+        return static_cast<unsigned char>(entry);
+    }
+};
@@ -73,7 +73,15 @@ enum class HuffmanErrorCode {
      * Thrown when attempting to read an archive file that has an invalid format,
      * corrupted headers, missing metadata, or incompatible version.
      */
-    ArchiveFormatError = 7
+    ArchiveFormatError = 7,
+    
+    /**
+     * @brief Command line option given an invalid value
+     * 
+     * Thrown when an option that takes a value (like -b for the block size)
+     * receives a value that cannot be parsed or is outside the allowed range.
+     */
+    InvalidArgument = 8
 };
 
 /**
@@ -217,4 +225,16 @@ public:
      * @return HuffmanException Configured exception with ArchiveFormatError error code
      */
     static HuffmanException archiveFormatError(const std::string& message);
+
+    /**
+     * @brief Create exception for an invalid command line option value
+     * 
+     * Factory method that creates a HuffmanException when an option that
+     * takes a value receives one that cannot be parsed or is out of range.
+     * 
+     * @param flag The option whose value was rejected (e.g., "-b")
+     * @param value The rejected value as given on the command line
+     * @return HuffmanException Configured exception with InvalidArgument error code
+     */
+    static HuffmanException invalidArgument(const std::string& flag, const std::string& value);
 };
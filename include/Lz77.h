@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief LZ77 front end of the high-ratio compression method
+ *
+ * A hash-chain match finder turns a block into sequences of (literal run,
+ * match length, match distance). The literals and the length and distance
+ * codes form four byte streams, each coded as a nested archive block with
+ * the regular block coder (so each gets its own canonical Huffman code, or
+ * is stored if it does not compress); the low bits of long lengths and
+ * distances go to a raw extra-bits stream.
+ *
+ * Values below a small threshold are their own code; larger ones are coded
+ * as two codes per power of two followed by the remaining low bits, as in
+ * deflate. Matches never reach outside the block, so blocks stay
+ * independently decodable.
+ *
+ * Payload layout: sequence count (4 bytes), literal count (4 bytes), the
+ * nested blocks for literals, literal-run codes, match-length codes and
+ * distance codes (each omitted when its stream is empty), then the
+ * extra-bits stream as a bit count (8 bytes) and its packed bytes.
+ */
+class Lz77 {
+public:
+    static const unsigned kMinLevel = 1;                 ///< Fastest effort level
+    static const unsigned kMaxLevel = 9;                 ///< Highest effort level
+    static const unsigned kDefaultLevel = 5;             ///< Effort level used when none is given
+    static const size_t kMinMatch = 4;                   ///< Shortest match emitted
+    static const size_t kMinWindow = 1024;               ///< Smallest accepted window
+    static const size_t kMaxWindow = size_t(64) << 20;   ///< Largest accepted window (64 MiB)
+    static const size_t kDefaultWindow = 256 * 1024;     ///< Window used when none is given
+
+    /**
+     * @brief Match finder settings
+     */
+    struct Parameters {
+        unsigned level;   ///< Effort level: longer hash chains and lazy matching at higher levels
+        size_t window;    ///< Farthest distance a match may reach back, in bytes
+
+        /**
+         * @brief Default constructor
+         *
+         * Uses the default level and window.
+         */
+        Parameters();
+    };
+
+    /**
+     * @brief Compress one block into an LZ77 payload
+     *
+     * @param data Pointer to the block contents
+     * @param size Number of bytes in the block
+     * @param parameters Effort level and window
+     * @param maxCodeLength Longest Huffman code allowed in the nested blocks
+     * @return std::vector<unsigned char> The payload
+     */
+    static std::vector<unsigned char> compress(const unsigned char* data, size_t size,
+                                               const Parameters& parameters, unsigned maxCodeLength);
+
+    /**
+     * @brief Decompress an LZ77 payload
+     *
+     * @param payload Pointer to the payload
+     * @param payloadSize Payload size in bytes
+     * @param out Output buffer receiving exactly outSize bytes
+     * @param outSize Number of bytes the payload decodes to
+     * @throws HuffmanException If the payload is corrupted or does not decode to outSize bytes
+     */
+    static void decompress(const unsigned char* payload, size_t payloadSize,
+                           unsigned char* out, size_t outSize);
+
+    /**
+     * @brief Describe the method and its settings for the archive metadata
+     *
+     * @param parameters Effort level and window
+     * @return std::string E.g. "LZ77+Huffman (level 5, window 262144 bytes)"
+     */
+    static std::string describe(const Parameters& parameters);
+};
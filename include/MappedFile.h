@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Read-only memory mapping of a whole file
+ *
+ * Maps a file into the address space so it can be read in place without
+ * copying it through stream buffers. Uses mmap() on POSIX systems and
+ * file mapping objects on Windows. When a file cannot be mapped (for
+ * example a pipe or an empty file) isMapped() returns false and callers
+ * fall back to regular stream reads.
+ */
+class MappedFile {
+private:
+    const unsigned char* mappedData;   ///< Start of the mapping (nullptr if not mapped)
+    size_t mappedSize;                 ///< Size of the mapped file in bytes
+#ifdef _WIN32
+    void* fileHandle;                  ///< Windows file handle
+    void* mappingHandle;               ///< Windows file mapping handle
+#endif
+
+public:
+    /**
+     * @brief Map a file read-only
+     *
+     * @param path Path of the file to map
+     * @param sequentialAccess Hint that the mapping will be read front to back
+     *                         (madvise(MADV_SEQUENTIAL) where available)
+     * @throws HuffmanException If the file cannot be opened
+     */
+    explicit MappedFile(const std::string& path, bool sequentialAccess = false);
+
+    /**
+     * @brief Unmap the file
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Check whether the file is mapped
+     * @return bool True if data() points to the file contents
+     */
+    bool isMapped() const;
+
+    /**
+     * @brief Get the mapped file contents
+     * @return const unsigned char* Start of the mapping (nullptr if not mapped)
+     */
+    const unsigned char* data() const;
+
+    /**
+     * @brief Get the size of the mapping
+     * @return size_t Number of mapped bytes (0 if not mapped)
+     */
+    size_t size() const;
+
+    /**
+     * @brief Tell the OS that a range of the mapping will not be read again
+     *
+     * Lets the kernel drop the range's pages from this process so resident
+     * memory stays bounded while a large file is processed front to back.
+     * The data remains readable; it is simply faulted in again if touched.
+     * Only whole pages inside the range are released.
+     *
+     * @param offset Start of the range in bytes
+     * @param length Length of the range in bytes
+     */
+    void release(size_t offset, size_t length) const;
+};
@@ -3,7 +3,7 @@
 /**
  * @brief Enumeration of allowed operations for the Huffman compression tool
  * 
- * This enum defines the three main modes of operation that the compression
+ * This enum defines the main modes of operation that the compression
  * utility can perform on files and directories.
  */
 enum class OperationMode {
@@ -33,6 +33,24 @@ enum class OperationMode {
      */
     Decode,
     
+    /**
+     * @brief Extract selected files from an archive
+     * 
+     * Restores only the named members of a .huf archive. Each member is
+     * located through the archive's file index, so the blocks of other
+     * files are neither read nor decoded.
+     */
+    Extract,
+    
+    /**
+     * @brief Verify an archive
+     * 
+     * Decodes every block of a .huf archive and checks the CRC-32C
+     * checksums of all blocks and files without writing any output,
+     * then reports the throughput.
+     */
+    Test,
+    
     /**
      * @brief Display archive information
      * 
@@ -40,5 +58,15 @@ enum class OperationMode {
      * directory structure, and compression statistics (with -v flag).
      * Does not modify any files.
      */
-    Info
+    Info,
+    
+    /**
+     * @brief Count byte frequencies into a table file
+     * 
+     * Counts the bytes of the input files (or of one shard of them) and
+     * merges any frequency table files given as inputs, then saves the
+     * result. The table can give every shard of a sharded encode the
+     * same global code.
+     */
+    Frequencies
 };
\ No newline at end of file
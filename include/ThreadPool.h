@@ -0,0 +1,85 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed-size pool of worker threads executing queued tasks
+ *
+ * Tasks are started in submission order. A pool created with a single
+ * thread runs every task directly inside submit(), so single-threaded
+ * operation behaves exactly like a plain function call and starts no
+ * threads at all.
+ */
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;           ///< Worker threads (empty when running inline)
+    std::deque<std::function<void()>> tasks;    ///< Tasks waiting for a worker
+    std::mutex queueMutex;                      ///< Guards tasks and stopping
+    std::condition_variable queueCondition;     ///< Signals new tasks or shutdown
+    bool stopping;                              ///< Set when the pool is being destroyed
+
+    /**
+     * @brief Worker loop: run queued tasks until the pool shuts down
+     */
+    void workerLoop();
+
+public:
+    /**
+     * @brief Construct a new Thread Pool
+     *
+     * @param threadCount Number of threads; 1 (or 0) runs tasks inline in submit()
+     */
+    explicit ThreadPool(size_t threadCount);
+
+    /**
+     * @brief Finish all queued tasks and join the worker threads
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Get the number of tasks that can run concurrently
+     * @return size_t Worker thread count (1 when running inline)
+     */
+    size_t getThreadCount() const;
+
+    /**
+     * @brief Queue a task for execution
+     *
+     * Exceptions thrown by the task are captured and rethrown by the
+     * returned future's get().
+     *
+     * @param task Callable taking no arguments
+     * @return std::future<R> Future for the task's result
+     */
+    template <typename Task>
+    auto submit(Task task) -> std::future<decltype(task())>
+    {
+        typedef decltype(task()) Result;
+        std::shared_ptr<std::packaged_task<Result()>> packaged =
+            std::make_shared<std::packaged_task<Result()>>(task);
+        std::future<Result> result = packaged->get_future();
+
+        if (workers.empty())
+        {
+            (*packaged)();
+            return result;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            tasks.push_back([packaged]() { (*packaged)(); });
+        }
+        queueCondition.notify_one();
+        return result;
+    }
+};
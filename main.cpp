@@ -23,10 +23,22 @@ int main(int argc, char* argv[])
         {
             success = HuffmanAlgorithm::decodeArchive(options);
         }
+        else if (options.getMode() == OperationMode::Extract)
+        {
+            success = HuffmanAlgorithm::extractFiles(options);
+        }
+        else if (options.getMode() == OperationMode::Test)
+        {
+            success = HuffmanAlgorithm::testArchive(options);
+        }
         else if (options.getMode() == OperationMode::Info)
         {
             success = HuffmanAlgorithm::displayArchiveInfo(options);
         }
+        else if (options.getMode() == OperationMode::Frequencies)
+        {
+            success = HuffmanAlgorithm::countFrequencies(options);
+        }
         
         if (options.isVerbose() && success)
         {
@@ -0,0 +1,151 @@
+#include "../include/ArchiveIO.h"
+#include <cstring>
+#include <limits>
+
+ArchiveReader::ArchiveReader(const unsigned char* archiveData, size_t archiveSize)
+    : data(archiveData), size(archiveSize), pos(0)
+{
+}
+
+uint8_t ArchiveReader::readU8()
+{
+    return *readBytes(1);
+}
+
+uint16_t ArchiveReader::readU16()
+{
+    const unsigned char* bytes = readBytes(2);
+    return static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
+}
+
+uint32_t ArchiveReader::readU32()
+{
+    const unsigned char* bytes = readBytes(4);
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; i--)
+    {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+uint64_t ArchiveReader::readU64()
+{
+    const unsigned char* bytes = readBytes(8);
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--)
+    {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+size_t ArchiveReader::readSize()
+{
+    uint64_t value = readU64();
+    if (value > std::numeric_limits<size_t>::max())
+    {
+        throw HuffmanException::archiveFormatError("Archive field too large for this platform");
+    }
+    return static_cast<size_t>(value);
+}
+
+double ArchiveReader::readF64()
+{
+    uint64_t bits = readU64();
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+const unsigned char* ArchiveReader::readBytes(size_t count)
+{
+    if (count > size - pos)
+    {
+        throw HuffmanException::archiveFormatError("Unexpected end of archive");
+    }
+    const unsigned char* start = data + pos;
+    pos += count;
+    return start;
+}
+
+std::string ArchiveReader::readString(size_t length)
+{
+    const unsigned char* start = readBytes(length);
+    return std::string(reinterpret_cast<const char*>(start), length);
+}
+
+void ArchiveReader::seek(size_t position)
+{
+    if (position > size)
+    {
+        throw HuffmanException::archiveFormatError("Offset beyond end of archive");
+    }
+    pos = position;
+}
+
+size_t ArchiveReader::position() const
+{
+    return pos;
+}
+
+size_t ArchiveReader::remaining() const
+{
+    return size - pos;
+}
+
+void ArchiveWriter::writeU8(uint8_t value)
+{
+    buffer.push_back(value);
+}
+
+void ArchiveWriter::writeU16(uint16_t value)
+{
+    buffer.push_back(static_cast<unsigned char>(value));
+    buffer.push_back(static_cast<unsigned char>(value >> 8));
+}
+
+void ArchiveWriter::writeU32(uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        buffer.push_back(static_cast<unsigned char>(value >> (8 * i)));
+    }
+}
+
+void ArchiveWriter::writeU64(uint64_t value)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        buffer.push_back(static_cast<unsigned char>(value >> (8 * i)));
+    }
+}
+
+void ArchiveWriter::writeF64(double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    writeU64(bits);
+}
+
+void ArchiveWriter::writeBytes(const void* bytes, size_t count)
+{
+    const unsigned char* start = static_cast<const unsigned char*>(bytes);
+    buffer.insert(buffer.end(), start, start + count);
+}
+
+const std::vector<unsigned char>& ArchiveWriter::data() const
+{
+    return buffer;
+}
+
+size_t ArchiveWriter::size() const
+{
+    return buffer.size();
+}
+
+void ArchiveWriter::flushTo(std::ostream& out)
+{
+    out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    buffer.clear();
+}
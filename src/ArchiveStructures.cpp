@@ -1,12 +1,20 @@
 #include "../include/ArchiveStructures.h"
+#include "../include/ArchiveIO.h"
+#include "../include/HuffmanCodeTable.h"
+#include "../include/ContextModel.h"
+#include "../include/DeltaFilter.h"
+#include "../include/HuffmanException.h"
+#include <cstring>
 
 FileEntry::FileEntry() 
-    : filename(""), relativePath(""), originalSize(0), compressedSize(0), offsetInArchive(0)
+    : filename(""), relativePath(""), originalSize(0), compressedSize(0), offsetInArchive(0), checksum(0), 
+      pieceOffset(0)
 {
 }
 
 FileEntry::FileEntry(const std::string& name, const std::string& path, size_t origSize)
-    : filename(name), relativePath(path), originalSize(origSize), compressedSize(0), offsetInArchive(0)
+    : filename(name), relativePath(path), originalSize(origSize), compressedSize(0), offsetInArchive(0),
+      checksum(0), pieceOffset(0)
 {
 }
 
@@ -23,20 +31,28 @@ void CompressionStatistics::printVerboseStatistics() const
     std::cout << "Compressed size: " << totalCompressedSize << " bytes\n";
     std::cout << "Compression ratio: " << compressionRatio << "%\n";
     std::cout << "Shannon information: " << shannonInfo << " bits/character\n";
-    std::cout << "Huffman average: " << huffmanAverage << " bits/character\n";
-    std::cout << "Efficiency: " << efficiency << "%\n\n";
+    if (huffmanAverage > 0)
+    {
+        std::cout << "Huffman average: " << huffmanAverage << " bits/character\n";
+        std::cout << "Efficiency: " << efficiency << "%\n\n";
+    }
+    else
+    {
+        std::cout << "Huffman average: n/a (no block is coded with a single Huffman code)\n\n";
+    }
     
     std::cout << "=== CHARACTER FREQUENCY TABLE ===\n";
     std::cout << "Nr\tChar\tFreq\tCode\t\t#bits\n";
     std::cout << "--------------------------------------------\n";
     
+    // Archives store only code lengths, so frequencies may be unknown here
     int index = 0;
-    for (const auto& pair : frequencies)
+    for (const auto& pair : huffmanCodes)
     {
         char ch = pair.first;
-        int freq = pair.second;
-        std::string code = huffmanCodes.at(ch);
+        const std::string& code = pair.second;
         int bits = codeLengths.at(ch);
+        auto freqIt = frequencies.find(ch);
         
         std::cout << index++ << "\t";
         if (ch == ' ')
@@ -75,25 +91,90 @@ void CompressionStatistics::printVerboseStatistics() const
         {
             std::cout << "'" << ch << "'";
         }
-        std::cout << "\t" << freq << "\t" << code << "\t\t" << bits << "\n";
+        std::cout << "\t";
+        if (freqIt != frequencies.end())
+            std::cout << freqIt->second;
+        else
+            std::cout << "-";
+        std::cout << "\t" << code << "\t\t" << bits << "\n";
     }
     std::cout << std::endl;
 }
 
+// Append a length-prefixed string to a serialized buffer
+static void writeString(ArchiveWriter& out, const std::string& text)
+{
+    out.writeU32(static_cast<uint32_t>(text.size()));
+    out.writeBytes(text.data(), text.size());
+}
+
+// Read a length-prefixed string written by writeString()
+static std::string readString(ArchiveReader& in)
+{
+    uint32_t length = in.readU32();
+    if (length > 4096)
+    {
+        throw HuffmanException::archiveFormatError("Invalid string length in archive metadata");
+    }
+    return in.readString(length);
+}
+
 std::vector<uint8_t> CompressionStatistics::serialize() const
 {
-    // TODO: Implement binary serialization of compression statistics
-    std::vector<uint8_t> result;
-    // This would serialize the statistics structure to binary format
-    return result;
+    // Scalar metrics, then (byte, code length, frequency) per used symbol.
+    // Codes are canonical, so they are rebuilt from the lengths on load.
+    ArchiveWriter out;
+    out.writeF64(shannonInfo);
+    out.writeF64(huffmanAverage);
+    out.writeF64(compressionRatio);
+    out.writeF64(efficiency);
+    out.writeU64(totalOriginalSize);
+    out.writeU64(totalCompressedSize);
+    
+    out.writeU16(static_cast<uint16_t>(codeLengths.size()));
+    for (const auto& pair : codeLengths)
+    {
+        auto freqIt = frequencies.find(pair.first);
+        out.writeU8(static_cast<uint8_t>(pair.first));
+        out.writeU8(static_cast<uint8_t>(pair.second));
+        out.writeU32(static_cast<uint32_t>(freqIt != frequencies.end() ? freqIt->second : 0));
+    }
+    return out.data();
 }
 
 CompressionStatistics CompressionStatistics::deserialize(const std::vector<uint8_t>& data)
 {
-    // TODO: Implement binary deserialization of compression statistics
-    (void)data; // Mark parameter as unused to avoid compiler warning
+    ArchiveReader in(data.data(), data.size());
     CompressionStatistics stats;
-    // This would deserialize the binary data back to statistics structure
+    stats.shannonInfo = in.readF64();
+    stats.huffmanAverage = in.readF64();
+    stats.compressionRatio = in.readF64();
+    stats.efficiency = in.readF64();
+    stats.totalOriginalSize = in.readSize();
+    stats.totalCompressedSize = in.readSize();
+    
+    uint16_t symbolCount = in.readU16();
+    if (symbolCount > 256)
+    {
+        throw HuffmanException::archiveFormatError("Invalid symbol count in archive metadata");
+    }
+    uint8_t lengths[256] = {0};
+    for (uint16_t i = 0; i < symbolCount; i++)
+    {
+        uint8_t symbol = in.readU8();
+        lengths[symbol] = in.readU8();
+        uint32_t frequency = in.readU32();
+        if (frequency > 0 && frequency <= 0x7FFFFFFF)
+        {
+            stats.frequencies[static_cast<char>(symbol)] = static_cast<int>(frequency);
+        }
+    }
+    
+    stats.huffmanCodes = HuffmanCodeTable::fromCodeLengths(lengths).toCodeStrings();
+    for (const auto& pair : stats.huffmanCodes)
+    {
+        stats.codeLengths[pair.first] = pair.second.length();
+    }
     return stats;
 }
 
@@ -104,6 +185,11 @@ ArchiveMetadata::ArchiveMetadata()
 
 void ArchiveMetadata::printArchiveInfo(bool verbose) const
 {
+    std::cout << "Compression method: " << compressionMethod << "\n";
+    if (!timestamp.empty())
+    {
+        std::cout << "Created: " << timestamp << "\n";
+    }
     std::cout << "Archive contains " << files.size() << " file(s):\n";
     
     for (const auto& file : files)
@@ -125,17 +211,450 @@ void ArchiveMetadata::printArchiveInfo(bool verbose) const
 
 std::vector<uint8_t> ArchiveMetadata::serialize() const
 {
-    // TODO: Implement binary serialization of archive metadata
-    std::vector<uint8_t> result;
-    // This would serialize the metadata structure to binary format
-    return result;
+    // [method][timestamp][num_files][file entries...][stats length][stats]
+    ArchiveWriter out;
+    writeString(out, compressionMethod);
+    writeString(out, timestamp);
+    
+    out.writeU32(static_cast<uint32_t>(files.size()));
+    for (const FileEntry& file : files)
+    {
+        writeString(out, file.filename);
+        writeString(out, file.relativePath);
+        out.writeU64(file.originalSize);
+        out.writeU64(file.compressedSize);
+        out.writeU64(file.offsetInArchive);
+        out.writeU32(file.checksum);
+        out.writeU64(file.pieceOffset);
+    }
+    
+    std::vector<uint8_t> statsData = stats.serialize();
+    out.writeU32(static_cast<uint32_t>(statsData.size()));
+    out.writeBytes(statsData.data(), statsData.size());
+    return out.data();
 }
 
 ArchiveMetadata ArchiveMetadata::deserialize(const std::vector<uint8_t>& data)
 {
-    // TODO: Implement binary deserialization of archive metadata
-    (void)data; // Mark parameter as unused to avoid compiler warning
+    ArchiveReader in(data.data(), data.size());
     ArchiveMetadata metadata;
-    // This would deserialize the binary data back to metadata structure
+    metadata.compressionMethod = readString(in);
+    metadata.timestamp = readString(in);
+    
+    uint32_t numFiles = in.readU32();
+    if (numFiles > in.remaining())
+    {
+        throw HuffmanException::archiveFormatError("Invalid file count in archive metadata");
+    }
+    for (uint32_t i = 0; i < numFiles; i++)
+    {
+        FileEntry file;
+        file.filename = readString(in);
+        file.relativePath = readString(in);
+        file.originalSize = in.readSize();
+        file.compressedSize = in.readSize();
+        file.offsetInArchive = in.readSize();
+        file.checksum = in.readU32();
+        file.pieceOffset = in.readU64();
+        metadata.files.push_back(file);
+    }
+    
+    uint32_t statsSize = in.readU32();
+    const uint8_t* statsData = in.readBytes(statsSize);
+    metadata.stats = CompressionStatistics::deserialize(std::vector<uint8_t>(statsData, statsData + statsSize));
     return metadata;
 }
+
+ArchiveHeader::ArchiveHeader()
+    : version(kVersion), flags(0), blockSize(0), fileCount(0), originalSize(0), blockCount(0)
+{
+    for (unsigned i = 0; i < kSectionCount; i++)
+    {
+        sections[i].offset = 0;
+        sections[i].length = 0;
+    }
+}
+
+void ArchiveHeader::writeTo(ArchiveWriter& out) const
+{
+    out.writeBytes(kMagic, sizeof(kMagic));
+    out.writeU16(version);
+    out.writeU16(flags);
+    out.writeU32(static_cast<uint32_t>(kSize));
+    out.writeU32(kSectionCount);
+    out.writeU32(blockSize);
+    out.writeU32(fileCount);
+    out.writeU64(originalSize);
+    out.writeU64(blockCount);
+    for (unsigned i = 0; i < kSectionCount; i++)
+    {
+        out.writeU64(sections[i].offset);
+        out.writeU64(sections[i].length);
+    }
+}
+
+ArchiveHeader ArchiveHeader::parse(ArchiveReader& reader, uint64_t archiveSize)
+{
+    // Reject anything that is not an archive before looking further
+    const unsigned char* magic = reader.readBytes(sizeof(kMagic));
+    if (std::memcmp(magic, kMagic, sizeof(kMagic)) != 0)
+    {
+        throw HuffmanException::archiveFormatError("Not a Huffman archive (bad magic number)");
+    }
+    
+    ArchiveHeader header;
+    header.version = reader.readU16();
+    if (header.version != kVersion)
+    {
+        throw HuffmanException::archiveFormatError("Unsupported archive version " + 
+                                                   std::to_string(header.version));
+    }
+    header.flags = reader.readU16();
+    if (header.flags != 0)
+    {
+        throw HuffmanException::archiveFormatError("Unsupported archive flags");
+    }
+    
+    // Later revisions may append sections; they extend the header size
+    uint32_t headerSize = reader.readU32();
+    uint32_t sectionCount = reader.readU32();
+    if (sectionCount < kSectionCount || headerSize < kSize || 
+        headerSize < kSize + (static_cast<uint64_t>(sectionCount) - kSectionCount) * 16)
+    {
+        throw HuffmanException::archiveFormatError("Corrupted archive header");
+    }
+    header.blockSize = reader.readU32();
+    header.fileCount = reader.readU32();
+    header.originalSize = reader.readU64();
+    header.blockCount = reader.readU64();
+    
+    // Sections follow the header in order and must lie inside the archive
+    uint64_t sectionStart = headerSize;
+    for (unsigned i = 0; i < kSectionCount; i++)
+    {
+        header.sections[i].offset = reader.readU64();
+        header.sections[i].length = reader.readU64();
+        if (header.sections[i].offset < sectionStart || header.sections[i].offset > archiveSize ||
+            header.sections[i].length > archiveSize - header.sections[i].offset)
+        {
+            throw HuffmanException::archiveFormatError("Archive section out of bounds");
+        }
+        sectionStart = header.sections[i].offset + header.sections[i].length;
+    }
+    return header;
+}
+
+const unsigned char ArchiveHeader::kMagic[4] = {'H', 'U', 'F', 0x1A};
+const uint16_t ArchiveHeader::kVersion;
+const size_t ArchiveHeader::kSize;
+
+// Two 4-bit code lengths per byte, high nibble first
+static void writeCodeLengths(ArchiveWriter& out, const uint8_t codeLengths[256])
+{
+    unsigned char packed[128];
+    for (int i = 0; i < 128; i++)
+    {
+        packed[i] = static_cast<unsigned char>((codeLengths[2 * i] << 4) | codeLengths[2 * i + 1]);
+    }
+    out.writeBytes(packed, sizeof(packed));
+}
+
+static void readCodeLengths(ArchiveReader& in, uint8_t codeLengths[256])
+{
+    const unsigned char* packed = in.readBytes(128);
+    for (int i = 0; i < 128; i++)
+    {
+        codeLengths[2 * i] = packed[i] >> 4;
+        codeLengths[2 * i + 1] = packed[i] & 0x0F;
+    }
+}
+
+size_t SharedCodeTables::count() const
+{
+    return lengths.size() / 256;
+}
+
+const uint8_t* SharedCodeTables::table(size_t index) const
+{
+    return lengths.data() + index * 256;
+}
+
+uint8_t SharedCodeTables::add(const uint8_t codeLengths[256])
+{
+    if (count() >= ArchiveBlock::kOwnCode)
+    {
+        throw HuffmanException::compressionError("Too many shared code tables");
+    }
+    lengths.insert(lengths.end(), codeLengths, codeLengths + 256);
+    return static_cast<uint8_t>(count() - 1);
+}
+
+void SharedCodeTables::writeTo(ArchiveWriter& out) const
+{
+    out.writeU32(static_cast<uint32_t>(count()));
+    for (size_t i = 0; i < count(); i++)
+    {
+        writeCodeLengths(out, table(i));
+    }
+}
+
+SharedCodeTables SharedCodeTables::parse(ArchiveReader& reader, size_t length)
+{
+    uint32_t tableCount = reader.readU32();
+    if (length != 4 + static_cast<uint64_t>(tableCount) * 128)
+    {
+        throw HuffmanException::archiveFormatError("Corrupted code tables section");
+    }
+    SharedCodeTables tables;
+    tables.lengths.resize(static_cast<size_t>(tableCount) * 256);
+    for (uint32_t i = 0; i < tableCount; i++)
+    {
+        readCodeLengths(reader, &tables.lengths[i * 256]);
+    }
+    return tables;
+}
+
+BlockIndexEntry::BlockIndexEntry()
+    : archiveOffset(0), originalSize(0), fileIndex(0), outputOffset(0)
+{
+}
+
+const uint8_t ArchiveBlock::kOwnCode;
+const uint8_t ArchiveBlock::kDeltaFlag;
+
+ArchiveBlock::ArchiveBlock()
+    : originalSize(0), checksum(0), mode(Coded), deltaStride(0), codeTable(kOwnCode), literalCount(0), runListSize(0),
+      packedSize(0), tableCount(0), mappedPayload(nullptr)
+{
+    for (int i = 0; i < 256; i++)
+    {
+        tableOf[i] = 0;
+    }
+    for (unsigned stream = 0; stream < kStreamCount; stream++)
+    {
+        streamBits[stream] = 0;
+    }
+    for (int i = 0; i < 256; i++)
+    {
+        codeLengths[i] = 0;
+    }
+}
+
+// Everything of a block before its payload
+static void writeBlockHeader(const ArchiveBlock& block, ArchiveWriter& header)
+{
+    header.writeU32(static_cast<uint32_t>(block.originalSize));
+    header.writeU32(block.checksum);
+    if (block.deltaStride != 0)
+    {
+        header.writeU8(block.mode | ArchiveBlock::kDeltaFlag);
+        header.writeU8(static_cast<uint8_t>(block.deltaStride));
+    }
+    else
+    {
+        header.writeU8(block.mode);
+    }
+    if (block.mode == ArchiveBlock::Lz77 || block.mode == ArchiveBlock::Bwt)
+    {
+        header.writeU32(static_cast<uint32_t>(block.packedSize));
+        return;
+    }
+    if (block.mode == ArchiveBlock::RunLength)
+    {
+        header.writeU32(static_cast<uint32_t>(block.literalCount));
+        header.writeU32(static_cast<uint32_t>(block.runListSize));
+    }
+    if (block.mode != ArchiveBlock::Stored)
+    {
+        bool context = block.mode == ArchiveBlock::Context;
+        header.writeU8(context ? static_cast<uint8_t>(block.tableCount) : block.codeTable);
+        for (unsigned stream = 0; stream < ArchiveBlock::kStreamCount; stream++)
+        {
+            header.writeU64(block.streamBits[stream]);
+        }
+        if (context)
+        {
+            writeCodeLengths(header, block.tableOf);
+            for (unsigned table = 0; table < block.tableCount; table++)
+            {
+                writeCodeLengths(header, &block.contextLengths[table * 256]);
+            }
+        }
+        else if (block.codeTable == ArchiveBlock::kOwnCode)
+        {
+            writeCodeLengths(header, block.codeLengths);
+        }
+    }
+}
+
+void ArchiveBlock::writeTo(std::ostream& out) const
+{
+    ArchiveWriter header;
+    writeBlockHeader(*this, header);
+    header.flushTo(out);
+    
+    out.write(reinterpret_cast<const char*>(payloadData()), payloadSize());
+}
+
+void ArchiveBlock::writeTo(ArchiveWriter& out) const
+{
+    writeBlockHeader(*this, out);
+    out.writeBytes(payloadData(), payloadSize());
+}
+
+const unsigned char* ArchiveBlock::payloadData() const
+{
+    return mappedPayload != nullptr ? mappedPayload : payload.data();
+}
+
+size_t ArchiveBlock::payloadSize() const
+{
+    if (mode == Stored)
+    {
+        return originalSize;
+    }
+    if (mode == Lz77 || mode == Bwt)
+    {
+        return packedSize;
+    }
+    size_t size = runListSize;
+    for (unsigned stream = 0; stream < kStreamCount; stream++)
+    {
+        size += streamSize(stream);
+    }
+    return size;
+}
+
+size_t ArchiveBlock::streamSize(unsigned stream) const
+{
+    return (streamBits[stream] + 7) / 8;
+}
+
+size_t ArchiveBlock::totalBits() const
+{
+    if (mode == Stored || mode == Lz77 || mode == Bwt)
+    {
+        return payloadSize() * 8;
+    }
+    size_t bits = 0;
+    for (unsigned stream = 0; stream < kStreamCount; stream++)
+    {
+        bits += streamBits[stream];
+    }
+    return bits;
+}
+
+ArchiveBlock ArchiveBlock::parse(ArchiveReader& reader, size_t maxOriginalSize, 
+                                 const SharedCodeTables& sharedCodes)
+{
+    ArchiveBlock block;
+    block.originalSize = reader.readU32();
+    block.checksum = reader.readU32();
+    block.mode = reader.readU8();
+    if (block.mode & kDeltaFlag)
+    {
+        block.mode &= ~kDeltaFlag;
+        block.deltaStride = reader.readU8();
+        if (block.deltaStride == 0 || block.deltaStride > DeltaFilter::kMaxStride || block.mode == Stored)
+        {
+            throw HuffmanException::archiveFormatError("Invalid delta filter");
+        }
+    }
+    if (block.mode == Stored)
+    {
+        if (block.originalSize == 0 || block.originalSize > maxOriginalSize)
+        {
+            throw HuffmanException::archiveFormatError("Invalid block size");
+        }
+        block.mappedPayload = reader.readBytes(block.originalSize);
+        return block;
+    }
+    if (block.mode == Lz77 || block.mode == Bwt)
+    {
+        block.packedSize = reader.readU32();
+        if (block.originalSize == 0 || block.originalSize > maxOriginalSize)
+        {
+            throw HuffmanException::archiveFormatError("Invalid block size");
+        }
+        block.mappedPayload = reader.readBytes(block.packedSize);
+        return block;
+    }
+    if (block.mode != Coded && block.mode != RunLength && block.mode != Context)
+    {
+        throw HuffmanException::archiveFormatError("Unknown block mode " + std::to_string(block.mode));
+    }
+    block.literalCount = block.originalSize;
+    if (block.mode == RunLength)
+    {
+        // Every run starts with a literal, so at least one literal is coded
+        block.literalCount = reader.readU32();
+        block.runListSize = reader.readU32();
+        if (block.literalCount == 0 || block.literalCount > block.originalSize)
+        {
+            throw HuffmanException::archiveFormatError("Invalid run-length block");
+        }
+    }
+    
+    bool context = block.mode == Context;
+    if (context)
+    {
+        block.tableCount = reader.readU8();
+    }
+    else
+    {
+        block.codeTable = reader.readU8();
+    }
+    for (unsigned stream = 0; stream < kStreamCount; stream++)
+    {
+        block.streamBits[stream] = reader.readSize();
+    }
+    if (context)
+    {
+        if (block.tableCount == 0 || block.tableCount > ContextModel::kMaxTables)
+        {
+            throw HuffmanException::archiveFormatError("Invalid context block");
+        }
+        readCodeLengths(reader, block.tableOf);
+        for (int i = 0; i < 256; i++)
+        {
+            if (block.tableOf[i] >= block.tableCount)
+            {
+                throw HuffmanException::archiveFormatError("Invalid context block");
+            }
+        }
+        block.contextLengths.resize(block.tableCount * 256);
+        for (unsigned table = 0; table < block.tableCount; table++)
+        {
+            readCodeLengths(reader, &block.contextLengths[table * 256]);
+        }
+    }
+    else if (block.codeTable == kOwnCode)
+    {
+        readCodeLengths(reader, block.codeLengths);
+    }
+    else if (block.codeTable < sharedCodes.count())
+    {
+        std::memcpy(block.codeLengths, sharedCodes.table(block.codeTable), sizeof(block.codeLengths));
+    }
+    else
+    {
+        throw HuffmanException::archiveFormatError("Block refers to a missing code table");
+    }
+    
+    // Reject sizes no valid encoder could produce before touching the payload
+    if (block.originalSize == 0 || block.originalSize > maxOriginalSize)
+    {
+        throw HuffmanException::archiveFormatError("Invalid block size");
+    }
+    size_t symbolsPerStream = (block.literalCount + kStreamCount - 1) / kStreamCount;
+    for (unsigned stream = 0; stream < kStreamCount; stream++)
+    {
+        if (block.streamBits[stream] > symbolsPerStream * HuffmanCodeTable::kMaxCodeLength)
+        {
+            throw HuffmanException::archiveFormatError("Invalid block size");
+        }
+    }
+    
+    block.mappedPayload = reader.readBytes(block.payloadSize());
+    return block;
+}
@@ -0,0 +1,62 @@
+#include "../include/BitStream.h"
+
+BitWriter::BitWriter(size_t expectedBytes)
+    : bytePos(0), accumulator(0), pendingBits(0), totalBits(0)
+{
+    // Leave room for the final partial word so flush() never reallocates
+    bytes.resize(expectedBytes + 8);
+}
+
+void BitWriter::ensureCapacity(size_t count)
+{
+    if (bytePos + count > bytes.size())
+    {
+        bytes.resize((bytes.size() + count) * 2);
+    }
+}
+
+void BitWriter::flush()
+{
+    ensureCapacity(8);
+
+    // Emit whole bytes still held in the accumulator
+    while (pendingBits >= 8)
+    {
+        pendingBits -= 8;
+        bytes[bytePos++] = static_cast<unsigned char>(accumulator >> pendingBits);
+    }
+
+    // Emit the final partial byte, left-aligned and zero padded
+    if (pendingBits > 0)
+    {
+        bytes[bytePos++] = static_cast<unsigned char>(accumulator << (8 - pendingBits));
+        pendingBits = 0;
+    }
+    accumulator = 0;
+}
+
+size_t BitWriter::getBitCount() const
+{
+    return totalBits;
+}
+
+std::vector<unsigned char> BitWriter::release()
+{
+    flush();
+    bytes.resize(bytePos);
+
+    std::vector<unsigned char> result;
+    result.swap(bytes);
+    bytePos = 0;
+    return result;
+}
+
+BitReader::BitReader(const unsigned char* input, size_t inputSize)
+    : data(input), size(inputSize), bytePos(0), buffer(0), bitsInBuffer(0), bitsConsumed(0)
+{
+}
+
+size_t BitReader::getBitsConsumed() const
+{
+    return bitsConsumed;
+}
@@ -0,0 +1,393 @@
+#include "../include/Bwt.h"
+#include "../include/ArchiveIO.h"
+#include "../include/ArchiveStructures.h"
+#include "../include/BitStream.h"
+#include "../include/HuffmanAlgorithm.h"
+#include "../include/HuffmanException.h"
+#include <cstring>
+
+// Symbols of the move-to-front output: two digits for zero-rank runs, then
+// rank + 1, with the last symbol shared by ranks 254 and 255
+static const unsigned kRunA = 0;
+static const unsigned kRunB = 1;
+static const unsigned kEscape = 255;
+
+// SA-IS after Nong, Zhang and Chan: classify suffixes as S or L type, sort
+// the LMS substrings by induced sorting, name them and recurse if names
+// repeat, then induce the full order from the sorted LMS suffixes.
+// Reduced problems are stored in the upper part of the suffix array.
+
+template <typename Symbol>
+static void getBuckets(const Symbol* text, int32_t length, int32_t alphabetSize,
+                       std::vector<int32_t>& buckets, bool ends)
+{
+    buckets.assign(alphabetSize, 0);
+    for (int32_t i = 0; i < length; i++)
+    {
+        buckets[text[i]]++;
+    }
+    int32_t sum = 0;
+    for (int32_t c = 0; c < alphabetSize; c++)
+    {
+        sum += buckets[c];
+        buckets[c] = ends ? sum : sum - buckets[c];
+    }
+}
+
+static inline bool isLms(const std::vector<unsigned char>& sType, int32_t i)
+{
+    return i > 0 && sType[i] && !sType[i - 1];
+}
+
+template <typename Symbol>
+static void induceSort(const Symbol* text, int32_t* suffixArray, int32_t length, int32_t alphabetSize,
+                       const std::vector<unsigned char>& sType, std::vector<int32_t>& buckets)
+{
+    // L-type suffixes from left to right into the bucket starts
+    getBuckets(text, length, alphabetSize, buckets, false);
+    for (int32_t i = 0; i < length; i++)
+    {
+        int32_t j = suffixArray[i] - 1;
+        if (j >= 0 && !sType[j])
+        {
+            suffixArray[buckets[text[j]]++] = j;
+        }
+    }
+    // S-type suffixes from right to left into the bucket ends
+    getBuckets(text, length, alphabetSize, buckets, true);
+    for (int32_t i = length - 1; i >= 0; i--)
+    {
+        int32_t j = suffixArray[i] - 1;
+        if (j >= 0 && sType[j])
+        {
+            suffixArray[--buckets[text[j]]] = j;
+        }
+    }
+}
+
+template <typename Symbol>
+static void suffixArrayIS(const Symbol* text, int32_t* suffixArray, int32_t length, int32_t alphabetSize)
+{
+    std::vector<unsigned char> sType(length);
+    sType[length - 1] = 1;
+    for (int32_t i = length - 2; i >= 0; i--)
+    {
+        sType[i] = text[i] < text[i + 1] || (text[i] == text[i + 1] && sType[i + 1]);
+    }
+
+    // Stage 1: sort the LMS substrings
+    std::vector<int32_t> buckets;
+    getBuckets(text, length, alphabetSize, buckets, true);
+    for (int32_t i = 0; i < length; i++)
+    {
+        suffixArray[i] = -1;
+    }
+    for (int32_t i = 1; i < length; i++)
+    {
+        if (isLms(sType, i))
+        {
+            suffixArray[--buckets[text[i]]] = i;
+        }
+    }
+    induceSort(text, suffixArray, length, alphabetSize, sType, buckets);
+
+    int32_t lmsCount = 0;
+    for (int32_t i = 0; i < length; i++)
+    {
+        if (isLms(sType, suffixArray[i]))
+        {
+            suffixArray[lmsCount++] = suffixArray[i];
+        }
+    }
+
+    // Name the LMS substrings; equal substrings get equal names. Two LMS
+    // positions are never adjacent, so position / 2 is a unique slot.
+    for (int32_t i = lmsCount; i < length; i++)
+    {
+        suffixArray[i] = -1;
+    }
+    int32_t names = 0;
+    int32_t previous = -1;
+    for (int32_t i = 0; i < lmsCount; i++)
+    {
+        int32_t position = suffixArray[i];
+        bool differs = previous < 0;
+        for (int32_t d = 0; !differs; d++)
+        {
+            if (text[position + d] != text[previous + d] || sType[position + d] != sType[previous + d])
+            {
+                differs = true;
+            }
+            else if (d > 0 && (isLms(sType, position + d) || isLms(sType, previous + d)))
+            {
+                break;
+            }
+        }
+        if (differs)
+        {
+            names++;
+            previous = position;
+        }
+        suffixArray[lmsCount + position / 2] = names - 1;
+    }
+    for (int32_t i = length - 1, j = length - 1; i >= lmsCount; i--)
+    {
+        if (suffixArray[i] >= 0)
+        {
+            suffixArray[j--] = suffixArray[i];
+        }
+    }
+
+    // Stage 2: sort the reduced string, recursing while names repeat
+    int32_t* reduced = suffixArray + length - lmsCount;
+    if (names < lmsCount)
+    {
+        suffixArrayIS(reduced, suffixArray, lmsCount, names);
+    }
+    else
+    {
+        for (int32_t i = 0; i < lmsCount; i++)
+        {
+            suffixArray[reduced[i]] = i;
+        }
+    }
+
+    // Stage 3: place the sorted LMS suffixes and induce the rest
+    getBuckets(text, length, alphabetSize, buckets, true);
+    for (int32_t i = 1, j = 0; i < length; i++)
+    {
+        if (isLms(sType, i))
+        {
+            reduced[j++] = i;
+        }
+    }
+    for (int32_t i = 0; i < lmsCount; i++)
+    {
+        suffixArray[i] = reduced[suffixArray[i]];
+    }
+    for (int32_t i = lmsCount; i < length; i++)
+    {
+        suffixArray[i] = -1;
+    }
+    for (int32_t i = lmsCount - 1; i >= 0; i--)
+    {
+        int32_t j = suffixArray[i];
+        suffixArray[i] = -1;
+        suffixArray[--buckets[text[j]]] = j;
+    }
+    induceSort(text, suffixArray, length, alphabetSize, sType, buckets);
+}
+
+void Bwt::buildSuffixArray(const uint16_t* text, int32_t* suffixArray,
+                           int32_t length, int32_t alphabetSize)
+{
+    suffixArrayIS(text, suffixArray, length, alphabetSize);
+}
+
+// Append the bijective base-2 digits of a zero-rank run of runLength
+static void writeZeroRun(std::vector<unsigned char>& symbols, size_t runLength)
+{
+    while (runLength > 0)
+    {
+        runLength--;
+        symbols.push_back(static_cast<unsigned char>((runLength & 1) ? kRunB : kRunA));
+        runLength >>= 1;
+    }
+}
+
+std::vector<unsigned char> Bwt::compress(const unsigned char* data, size_t size, unsigned maxCodeLength)
+{
+    // Sort the block with a sentinel below every byte value appended; the
+    // last column skips the sentinel's row, whose position is the primary
+    // index
+    int32_t length = static_cast<int32_t>(size + 1);
+    std::vector<uint16_t> text(size + 1);
+    for (size_t i = 0; i < size; i++)
+    {
+        text[i] = static_cast<uint16_t>(data[i] + 1);
+    }
+    text[size] = 0;
+    std::vector<int32_t> suffixArray(size + 1);
+    buildSuffixArray(text.data(), suffixArray.data(), length, 257);
+    text = std::vector<uint16_t>();
+
+    std::vector<unsigned char> lastColumn(size);
+    uint32_t primary = 0;
+    for (int32_t row = 0, i = 0; row < length; row++)
+    {
+        if (suffixArray[row] == 0)
+        {
+            primary = static_cast<uint32_t>(row);
+        }
+        else
+        {
+            lastColumn[i++] = data[suffixArray[row] - 1];
+        }
+    }
+    suffixArray = std::vector<int32_t>();
+
+    // Move-to-front with zero-rank runs
+    unsigned char order[256];
+    for (int symbol = 0; symbol < 256; symbol++)
+    {
+        order[symbol] = static_cast<unsigned char>(symbol);
+    }
+    std::vector<unsigned char> symbols;
+    symbols.reserve(size / 2);
+    BitWriter extraBits;
+    size_t zeroRun = 0;
+    for (size_t i = 0; i < size; i++)
+    {
+        unsigned char byte = lastColumn[i];
+        if (order[0] == byte)
+        {
+            zeroRun++;
+            continue;
+        }
+        writeZeroRun(symbols, zeroRun);
+        zeroRun = 0;
+
+        unsigned rank = 1;
+        while (order[rank] != byte)
+        {
+            rank++;
+        }
+        std::memmove(order + 1, order, rank);
+        order[0] = byte;
+        if (rank < 254)
+        {
+            symbols.push_back(static_cast<unsigned char>(rank + 1));
+        }
+        else
+        {
+            symbols.push_back(static_cast<unsigned char>(kEscape));
+            extraBits.writeBits(rank - 254, 1);
+        }
+    }
+    writeZeroRun(symbols, zeroRun);
+
+    ArchiveWriter out;
+    out.writeU32(primary);
+    out.writeU32(static_cast<uint32_t>(symbols.size()));
+    CompressionStatistics stats;
+    HuffmanAlgorithm::compressBlock(symbols.data(), symbols.size(), stats, maxCodeLength).writeTo(out);
+    size_t bitCount = extraBits.getBitCount();
+    std::vector<unsigned char> bits = extraBits.release();
+    out.writeU64(bitCount);
+    out.writeBytes(bits.data(), bits.size());
+    return out.data();
+}
+
+void Bwt::decompress(const unsigned char* payload, size_t payloadSize,
+                     unsigned char* out, size_t outSize)
+{
+    ArchiveReader in(payload, payloadSize);
+    size_t primary = in.readU32();
+    size_t symbolCount = in.readU32();
+    if (primary == 0 || primary > outSize || symbolCount == 0 || symbolCount > outSize)
+    {
+        throw HuffmanException::archiveFormatError("Invalid BWT block");
+    }
+    std::vector<unsigned char> symbols(symbolCount);
+    ArchiveBlock block = ArchiveBlock::parse(in, symbolCount, SharedCodeTables());
+    if (block.originalSize != symbolCount || block.mode == ArchiveBlock::Lz77 || block.mode == ArchiveBlock::Bwt)
+    {
+        throw HuffmanException::archiveFormatError("Invalid BWT block");
+    }
+    HuffmanAlgorithm::decompressBlock(block, symbols.data());
+    uint64_t bitCount = in.readU64();
+    if (bitCount > static_cast<uint64_t>(in.remaining()) * 8)
+    {
+        throw HuffmanException::archiveFormatError("Invalid BWT block");
+    }
+    size_t bitBytes = static_cast<size_t>((bitCount + 7) / 8);
+    BitReader extraBits(in.readBytes(bitBytes), bitBytes);
+
+    // Undo the zero-run coding and move-to-front into the last column
+    std::vector<unsigned char> lastColumn(outSize);
+    unsigned char order[256];
+    for (int symbol = 0; symbol < 256; symbol++)
+    {
+        order[symbol] = static_cast<unsigned char>(symbol);
+    }
+    size_t written = 0;
+    size_t zeroRun = 0;
+    size_t digit = 1;
+    for (size_t i = 0; i <= symbolCount; i++)
+    {
+        unsigned symbol = i < symbolCount ? symbols[i] : kEscape + 1;
+        if (symbol == kRunA || symbol == kRunB)
+        {
+            zeroRun += symbol == kRunA ? digit : 2 * digit;
+            digit <<= 1;
+            if (zeroRun > outSize - written)
+            {
+                throw HuffmanException::archiveFormatError("Invalid BWT block");
+            }
+            continue;
+        }
+        std::memset(&lastColumn[written], order[0], zeroRun);
+        written += zeroRun;
+        zeroRun = 0;
+        digit = 1;
+        if (i == symbolCount)
+        {
+            break;
+        }
+
+        unsigned rank = symbol - 1;
+        if (symbol == kEscape)
+        {
+            extraBits.refill();
+            rank = 254 + static_cast<unsigned>(extraBits.peek(1));
+            extraBits.consume(1);
+        }
+        if (written == outSize)
+        {
+            throw HuffmanException::archiveFormatError("Invalid BWT block");
+        }
+        unsigned char byte = order[rank];
+        std::memmove(order + 1, order, rank);
+        order[0] = byte;
+        lastColumn[written++] = byte;
+    }
+    if (written != outSize || extraBits.getBitsConsumed() > bitCount)
+    {
+        throw HuffmanException::archiveFormatError("Invalid BWT block");
+    }
+
+    // Invert the transform. Row 0 is the sentinel's suffix, so the rows of
+    // byte c start after the counts of all smaller bytes plus one; next[r]
+    // is the row of the suffix one past row r's. Starting from the primary
+    // row (the whole block) and following next yields the bytes in order.
+    size_t starts[256];
+    size_t total = 1;
+    size_t counts[256] = {0};
+    for (size_t i = 0; i < outSize; i++)
+    {
+        counts[lastColumn[i]]++;
+    }
+    for (int symbol = 0; symbol < 256; symbol++)
+    {
+        starts[symbol] = total;
+        total += counts[symbol];
+    }
+    std::vector<uint32_t> next(outSize + 1);
+    next[0] = static_cast<uint32_t>(primary);
+    for (size_t i = 0; i < outSize; i++)
+    {
+        size_t row = i + (i >= primary);
+        next[starts[lastColumn[i]]++] = static_cast<uint32_t>(row);
+    }
+    size_t row = primary;
+    for (size_t i = 0; i < outSize; i++)
+    {
+        row = next[row];
+        out[i] = lastColumn[row - (row >= primary)];
+    }
+}
+
+std::string Bwt::describe()
+{
+    return "BWT+MTF+Huffman";
+}
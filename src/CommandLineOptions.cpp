@@ -1,6 +1,16 @@
 #include "../include/CommandLineOptions.h"
+#include "../include/Lz77.h"
+#include "../include/DeltaFilter.h"
 #include <cstdlib>
 
+const size_t CommandLineOptions::kDefaultBlockSize;
+const size_t CommandLineOptions::kMinBlockSize;
+const size_t CommandLineOptions::kMaxBlockSize;
+const size_t CommandLineOptions::kMaxThreads;
+const unsigned CommandLineOptions::kMinCodeLengthLimit;
+const unsigned CommandLineOptions::kMaxCodeLengthLimit;
+const size_t CommandLineOptions::kMaxShards;
+
 // Constructor implementation
 CommandLineOptions::CommandLineOptions(int argc, char *argv[]) 
 {
@@ -43,6 +53,98 @@ const std::vector<std::string>& CommandLineOptions::getInputFiles() const
     return inputFiles; 
 }
 
+size_t CommandLineOptions::getBlockSize() const 
+{ 
+    return blockSize; 
+}
+
+size_t CommandLineOptions::getThreadCount() const 
+{ 
+    return threadCount; 
+}
+
+unsigned CommandLineOptions::getMaxCodeLength() const 
+{ 
+    return maxCodeLength; 
+}
+
+size_t CommandLineOptions::getShardIndex() const 
+{ 
+    return shardIndex; 
+}
+
+size_t CommandLineOptions::getShardCount() const 
+{ 
+    return shardCount; 
+}
+
+const std::string& CommandLineOptions::getCodeTableFile() const 
+{ 
+    return codeTableFile; 
+}
+
+bool CommandLineOptions::isRunLengthEnabled() const 
+{ 
+    return runLength; 
+}
+
+bool CommandLineOptions::isOrder1Enabled() const 
+{ 
+    return order1; 
+}
+
+unsigned CommandLineOptions::getDeltaStride() const 
+{ 
+    return deltaStride; 
+}
+
+CompressionMethod CommandLineOptions::getMethod() const 
+{ 
+    return method; 
+}
+
+unsigned CommandLineOptions::getLevel() const 
+{ 
+    return level; 
+}
+
+size_t CommandLineOptions::getWindowSize() const 
+{ 
+    return windowSize; 
+}
+
+// Parse a byte count with an optional K/M/G suffix (binary units)
+static size_t parseSize(const std::string& flag, const std::string& value)
+{
+    size_t digits = 0;
+    unsigned long long number = 0;
+    while (digits < value.size() && value[digits] >= '0' && value[digits] <= '9')
+    {
+        number = number * 10 + (value[digits] - '0');
+        if (number > (1ULL << 40))
+        {
+            throw HuffmanException::invalidArgument(flag, value);
+        }
+        digits++;
+    }
+    if (digits == 0)
+    {
+        throw HuffmanException::invalidArgument(flag, value);
+    }
+    
+    std::string suffix = value.substr(digits);
+    if (suffix == "K" || suffix == "k")
+        number <<= 10;
+    else if (suffix == "M" || suffix == "m")
+        number <<= 20;
+    else if (suffix == "G" || suffix == "g")
+        number <<= 30;
+    else if (!suffix.empty())
+        throw HuffmanException::invalidArgument(flag, value);
+    
+    return static_cast<size_t>(number);
+}
+
 void CommandLineOptions::printUsage(const char* programName) 
 {
     std::cout << "Huffman Compression Utility\n";
@@ -50,14 +152,43 @@ void CommandLineOptions::printUsage(const char* programName)
     std::cout << "Options:\n";
     std::cout << "  -e, --encode     Encode (compress) files using Huffman algorithm\n";
     std::cout << "  -d, --decode     Decode (decompress) archive to original files\n";
+    std::cout << "  -x, --extract    Extract the named files from an archive\n";
+    std::cout << "  -t, --test       Verify archive checksums without writing files\n";
     std::cout << "  -i, --info       Display archive contents and information\n";
+    std::cout << "  -f, --frequencies Count byte frequencies of the inputs into a table file (-o);\n";
+    std::cout << "                   table files given as inputs are merged\n";
     std::cout << "  -r, --recursive  Operate recursively on directories (encode only)\n";
     std::cout << "  -v, --verbose    Display detailed information and statistics\n";
-    std::cout << "  -o, --output     Specify output archive file (required for encode)\n\n";
+    std::cout << "  -o, --output     Specify output archive file (required for encode)\n";
+    std::cout << "                   or output directory (decode/extract)\n";
+    std::cout << "  -b, --block-size Bytes per independently coded block, e.g. 256K or 4M (default 1M)\n";
+    std::cout << "  -j, --threads    Number of threads (de)compressing blocks in parallel (default 1)\n";
+    std::cout << "  --max-code-len   Longest Huffman code in bits, 11 to 15 (default 15)\n";
+    std::cout << "  --shard I/N      Process only shard I (0 to N-1) of the inputs (encode/frequencies);\n";
+    std::cout << "                   shard archives joined with cat form one archive\n";
+    std::cout << "  --code-from F    Code every block with the code of frequency table F (encode only)\n";
+    std::cout << "  --rle            Code long runs of one byte value as runs (encode only)\n";
+    std::cout << "  --order1         Pick each byte's code table by the byte before it (encode only)\n";
+    std::cout << "  --delta N|auto   Delta-filter blocks of N-byte numbers (1 to 32), or detect N per block\n";
+    std::cout << "                   (encode only)\n";
+    std::cout << "  -m, --method M   Compression method: huffman (default), lz77 or bwt (encode only)\n";
+    std::cout << "  --level N        LZ77 effort, 1 (fastest) to 9 (smallest) (default 5)\n";
+    std::cout << "  --window SIZE    LZ77 window, 1K to 64M (default 256K)\n\n";
     std::cout << "Examples:\n";
     std::cout << "  " << programName << " -e file1.txt file2.txt -o archive.huf\n";
     std::cout << "  " << programName << " -e -r mydir -o mydir.huf -v\n";
+    std::cout << "  " << programName << " -e -j 8 big.log -o big.huf\n";
+    std::cout << "  " << programName << " -e --max-code-len 11 data.bin -o data.huf\n";
+    std::cout << "  " << programName << " -e --rle disk.img -o disk.huf\n";
+    std::cout << "  " << programName << " -e -r --order1 src -o src.huf\n";
+    std::cout << "  " << programName << " -e --delta auto telemetry.bin -o telemetry.huf\n";
+    std::cout << "  " << programName << " -e -j 8 -m bwt -b 4M corpus.txt -o corpus.huf\n";
+    std::cout << "  " << programName << " -e -r -m lz77 --level 9 --window 4M logs -o logs.huf\n";
+    std::cout << "  " << programName << " -e --shard 0/2 big.log -o part0.huf\n";
+    std::cout << "  " << programName << " -f part0.freq part1.freq -o global.freq\n";
     std::cout << "  " << programName << " -d archive.huf\n";
+    std::cout << "  " << programName << " -x archive.huf file2.txt -o restored\n";
+    std::cout << "  " << programName << " -t -j 4 archive.huf\n";
     std::cout << "  " << programName << " -i archive.huf -v\n";
 }
 
@@ -66,7 +197,19 @@ void CommandLineOptions::parseCommandLine(int argc, char* argv[])
     // Initialize all flags and mode
     recursive = false;
     verbose = false;
+    runLength = false;
+    order1 = false;
+    deltaStride = 0;
+    method = CompressionMethod::Huffman;
+    methodSpecified = false;
+    level = 0;
+    windowSize = 0;
     mode = OperationMode::None;
+    blockSize = 0;
+    threadCount = 0;
+    maxCodeLength = 0;
+    shardIndex = 0;
+    shardCount = 0;
     
     if (argc < 2) 
     {
@@ -91,6 +234,27 @@ void CommandLineOptions::parseCommandLine(int argc, char* argv[])
             }
             mode = OperationMode::Decode;
         }
+        else if (arg == "-x" || arg == "--extract") 
+        {
+            if (mode != OperationMode::None) {
+                throw HuffmanException::invalidMode("Multiple operation modes specified");
+            }
+            mode = OperationMode::Extract;
+        }
+        else if (arg == "-t" || arg == "--test") 
+        {
+            if (mode != OperationMode::None) {
+                throw HuffmanException::invalidMode("Multiple operation modes specified");
+            }
+            mode = OperationMode::Test;
+        }
+        else if (arg == "-f" || arg == "--frequencies") 
+        {
+            if (mode != OperationMode::None) {
+                throw HuffmanException::invalidMode("Multiple operation modes specified");
+            }
+            mode = OperationMode::Frequencies;
+        }
         else if (arg == "-i" || arg == "--info") 
         {
             if (mode != OperationMode::None) {
@@ -123,6 +287,176 @@ void CommandLineOptions::parseCommandLine(int argc, char* argv[])
                 throw HuffmanException::missingArgument("-o");
             }
         }
+        else if (arg == "-b" || arg == "--block-size") 
+        {
+            if (blockSize != 0) {
+                throw HuffmanException::invalidMode("Block size (-b) specified multiple times");
+            }
+            if (i + 1 < argc) {
+                std::string value = argv[++i];
+                blockSize = parseSize(arg, value);
+                if (blockSize < kMinBlockSize || blockSize > kMaxBlockSize) {
+                    throw HuffmanException::invalidArgument(arg, value);
+                }
+            } else {
+                throw HuffmanException::missingArgument("-b");
+            }
+        }
+        else if (arg == "-j" || arg == "--threads") 
+        {
+            if (threadCount != 0) {
+                throw HuffmanException::invalidMode("Thread count (-j) specified multiple times");
+            }
+            if (i + 1 < argc) {
+                std::string value = argv[++i];
+                threadCount = parseSize(arg, value);
+                if (threadCount < 1 || threadCount > kMaxThreads || value.find_first_not_of("0123456789") != std::string::npos) {
+                    throw HuffmanException::invalidArgument(arg, value);
+                }
+            } else {
+                throw HuffmanException::missingArgument("-j");
+            }
+        }
+        else if (arg == "--max-code-len") 
+        {
+            if (maxCodeLength != 0) {
+                throw HuffmanException::invalidMode("Maximum code length (--max-code-len) specified multiple times");
+            }
+            if (i + 1 < argc) {
+                std::string value = argv[++i];
+                if (value.empty() || value.size() > 2 || value.find_first_not_of("0123456789") != std::string::npos) {
+                    throw HuffmanException::invalidArgument(arg, value);
+                }
+                maxCodeLength = static_cast<unsigned>(std::atoi(value.c_str()));
+                if (maxCodeLength < kMinCodeLengthLimit || maxCodeLength > kMaxCodeLengthLimit) {
+                    throw HuffmanException::invalidArgument(arg, value);
+                }
+            } else {
+                throw HuffmanException::missingArgument("--max-code-len");
+            }
+        }
+        else if (arg == "--shard") 
+        {
+            if (shardCount != 0) {
+                throw HuffmanException::invalidMode("Shard (--shard) specified multiple times");
+            }
+            if (i + 1 < argc) {
+                std::string value = argv[++i];
+                size_t slash = value.find('/');
+                if (slash == std::string::npos || slash == 0 || slash + 1 == value.size() ||
+                    value.find_first_not_of("0123456789/") != std::string::npos ||
+                    value.find('/', slash + 1) != std::string::npos ||
+                    slash > 5 || value.size() - slash - 1 > 5) {
+                    throw HuffmanException::invalidArgument(arg, value);
+                }
+                shardIndex = static_cast<size_t>(std::atol(value.substr(0, slash).c_str()));
+                shardCount = static_cast<size_t>(std::atol(value.substr(slash + 1).c_str()));
+                if (shardCount < 1 || shardCount > kMaxShards || shardIndex >= shardCount) {
+                    throw HuffmanException::invalidArgument(arg, value);
+                }
+            } else {
+                throw HuffmanException::missingArgument("--shard");
+            }
+        }
+        else if (arg == "--code-from") 
+        {
+            if (!codeTableFile.empty()) {
+                throw HuffmanException::invalidMode("Code table (--code-from) specified multiple times");
+            }
+            if (i + 1 < argc) {
+                codeTableFile = argv[++i];
+            } else {
+                throw HuffmanException::missingArgument("--code-from");
+            }
+        }
+        else if (arg == "--rle") 
+        {
+            if (runLength) {
+                throw HuffmanException::invalidMode("Run-length flag (--rle) specified multiple times");
+            }
+            runLength = true;
+        }
+        else if (arg == "--order1") 
+        {
+            if (order1) {
+                throw HuffmanException::invalidMode("Order-1 flag (--order1) specified multiple times");
+            }
+            order1 = true;
+        }
+        else if (arg == "--delta") 
+        {
+            if (deltaStride != 0) {
+                throw HuffmanException::invalidMode("Delta filter (--delta) specified multiple times");
+            }
+            if (i + 1 < argc) {
+                std::string value = argv[++i];
+                if (value == "auto") {
+                    deltaStride = DeltaFilter::kAutoStride;
+                } else {
+                    if (value.empty() || value.size() > 2 || value.find_first_not_of("0123456789") != std::string::npos) {
+                        throw HuffmanException::invalidArgument(arg, value);
+                    }
+                    deltaStride = static_cast<unsigned>(std::atoi(value.c_str()));
+                    if (deltaStride < 1 || deltaStride > DeltaFilter::kMaxStride) {
+                        throw HuffmanException::invalidArgument(arg, value);
+                    }
+                }
+            } else {
+                throw HuffmanException::missingArgument("--delta");
+            }
+        }
+        else if (arg == "-m" || arg == "--method") 
+        {
+            if (methodSpecified) {
+                throw HuffmanException::invalidMode("Compression method (-m) specified multiple times");
+            }
+            if (i + 1 < argc) {
+                std::string value = argv[++i];
+                if (value == "huffman") {
+                    method = CompressionMethod::Huffman;
+                } else if (value == "lz77") {
+                    method = CompressionMethod::Lz77;
+                } else if (value == "bwt") {
+                    method = CompressionMethod::Bwt;
+                } else {
+                    throw HuffmanException::invalidArgument(arg, value);
+                }
+                methodSpecified = true;
+            } else {
+                throw HuffmanException::missingArgument("-m");
+            }
+        }
+        else if (arg == "--level") 
+        {
+            if (level != 0) {
+                throw HuffmanException::invalidMode("Effort level (--level) specified multiple times");
+            }
+            if (i + 1 < argc) {
+                std::string value = argv[++i];
+                if (value.size() != 1 || value[0] < '0' + static_cast<int>(Lz77::kMinLevel) || 
+                    value[0] > '0' + static_cast<int>(Lz77::kMaxLevel)) {
+                    throw HuffmanException::invalidArgument(arg, value);
+                }
+                level = static_cast<unsigned>(value[0] - '0');
+            } else {
+                throw HuffmanException::missingArgument("--level");
+            }
+        }
+        else if (arg == "--window") 
+        {
+            if (windowSize != 0) {
+                throw HuffmanException::invalidMode("Window size (--window) specified multiple times");
+            }
+            if (i + 1 < argc) {
+                std::string value = argv[++i];
+                windowSize = parseSize(arg, value);
+                if (windowSize < Lz77::kMinWindow || windowSize > Lz77::kMaxWindow) {
+                    throw HuffmanException::invalidArgument(arg, value);
+                }
+            } else {
+                throw HuffmanException::missingArgument("--window");
+            }
+        }
         else if (arg[0] != '-') 
         {
             // Input file or directory
@@ -140,7 +474,7 @@ void CommandLineOptions::validateOptions()
     // Check if operation mode was specified
     if (mode == OperationMode::None) 
     {
-        throw HuffmanException::invalidMode("No operation mode specified (use -e, -d, or -i)");
+        throw HuffmanException::invalidMode("No operation mode specified (use -e, -d, -x, -t, -i, or -f)");
     }
     
     // Check encode-specific requirements
@@ -154,14 +488,119 @@ void CommandLineOptions::validateOptions()
         }
     }
     
+    // Check frequency table requirements
+    if (mode == OperationMode::Frequencies) 
+    {
+        if (inputFiles.empty()) {
+            throw HuffmanException::invalidMode("No input files specified for frequency counting");
+        }
+        if (outputFile.empty()) {
+            throw HuffmanException::invalidMode("Frequency counting requires an output table file (-o)");
+        }
+    }
+    
     // Check decode/info requirements
-    if (mode == OperationMode::Decode || mode == OperationMode::Info) 
+    if (mode == OperationMode::Decode || mode == OperationMode::Test || mode == OperationMode::Info) 
     {
         if (inputFiles.size() != 1) {
-            throw HuffmanException::invalidMode("Exactly one archive file required for decode/info operations");
+            throw HuffmanException::invalidMode("Exactly one archive file required for decode/test/info operations");
+        }
+    }
+    
+    // Check extract requirements: the archive followed by the member names
+    if (mode == OperationMode::Extract) 
+    {
+        if (inputFiles.size() < 2) {
+            throw HuffmanException::invalidMode("Extract requires an archive file and at least one file name");
         }
     }
     
+    // Check block size usage
+    if (blockSize != 0 && mode != OperationMode::Encode) 
+    {
+        throw HuffmanException::invalidMode("Block size (-b) can only be used with encode (-e)");
+    }
+    if (blockSize == 0) 
+    {
+        blockSize = kDefaultBlockSize;
+    }
+    
+    // Check thread count usage
+    if (threadCount != 0 && (mode == OperationMode::Info || mode == OperationMode::Frequencies)) 
+    {
+        throw HuffmanException::invalidMode("Thread count (-j) can only be used with encode (-e), decode (-d), extract (-x) or test (-t)");
+    }
+    if (threadCount == 0) 
+    {
+        threadCount = 1;
+    }
+    
+    // Check maximum code length usage
+    if (maxCodeLength != 0 && mode != OperationMode::Encode) 
+    {
+        throw HuffmanException::invalidMode("Maximum code length (--max-code-len) can only be used with encode (-e)");
+    }
+    if (maxCodeLength == 0) 
+    {
+        maxCodeLength = kMaxCodeLengthLimit;
+    }
+    
+    // Check shard usage
+    if (shardCount != 0 && mode != OperationMode::Encode && mode != OperationMode::Frequencies) 
+    {
+        throw HuffmanException::invalidMode("Shard (--shard) can only be used with encode (-e) or frequencies (-f)");
+    }
+    if (shardCount == 0) 
+    {
+        shardCount = 1;
+    }
+    
+    // Check shared code usage
+    if (!codeTableFile.empty() && mode != OperationMode::Encode) 
+    {
+        throw HuffmanException::invalidMode("Code table (--code-from) can only be used with encode (-e)");
+    }
+    
+    // Check run-length flag usage
+    if (runLength && mode != OperationMode::Encode) 
+    {
+        throw HuffmanException::invalidMode("Run-length flag (--rle) can only be used with encode (-e)");
+    }
+    
+    // Check order-1 flag usage
+    if (order1 && mode != OperationMode::Encode) 
+    {
+        throw HuffmanException::invalidMode("Order-1 flag (--order1) can only be used with encode (-e)");
+    }
+    
+    // Check delta filter usage
+    if (deltaStride != 0 && mode != OperationMode::Encode) 
+    {
+        throw HuffmanException::invalidMode("Delta filter (--delta) can only be used with encode (-e)");
+    }
+    
+    // Check compression method usage
+    if (methodSpecified && mode != OperationMode::Encode) 
+    {
+        throw HuffmanException::invalidMode("Compression method (-m) can only be used with encode (-e)");
+    }
+    if (level != 0 && method != CompressionMethod::Lz77) 
+    {
+        throw HuffmanException::invalidMode("Effort level (--level) can only be used with --method lz77");
+    }
+    if (windowSize != 0 && method != CompressionMethod::Lz77) 
+    {
+        throw HuffmanException::invalidMode("Window size (--window) can only be used with --method lz77");
+    }
+    if (level == 0) 
+    {
+        level = Lz77::kDefaultLevel;
+    }
+    if (windowSize == 0) 
+    {
+        windowSize = Lz77::kDefaultWindow;
+    }
+    
     // Check recursive flag usage
     if (recursive && mode != OperationMode::Encode) 
     {
@@ -0,0 +1,297 @@
+#include "../include/ContextModel.h"
+#include "../include/HuffmanCodeTable.h"
+#include "../include/BitStream.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+const unsigned ContextModel::kMaxTables;
+const unsigned ContextModel::kStreamCount;
+const size_t ContextModel::kMinBlockSize;
+
+// Bits one stored code table costs (128 bytes of nibble-packed lengths)
+static const uint64_t kTableBits = 128 * 8;
+
+// While clustering, a byte a code cannot express is charged this many bits,
+// so contexts move towards codes that already cover their bytes
+static const uint64_t kMissingBits = 24;
+
+// Refinement rounds of the context assignment
+static const unsigned kAssignRounds = 8;
+
+// One group of contexts sharing a code
+struct ContextCluster {
+    uint64_t counts[256];   // Next-byte counts summed over the group
+    uint8_t lengths[256];   // Code built from counts
+    uint64_t bits;          // Payload bits of the group under its code
+};
+
+static void buildCode(ContextCluster& cluster, unsigned maxCodeLength)
+{
+    HuffmanCodeTable::computeCodeLengths(cluster.counts, cluster.lengths);
+    HuffmanCodeTable::limitCodeLengths(cluster.lengths, cluster.counts, maxCodeLength);
+    cluster.bits = 0;
+    for (int symbol = 0; symbol < 256; symbol++)
+    {
+        cluster.bits += cluster.counts[symbol] * cluster.lengths[symbol];
+    }
+}
+
+// Payload bits of two clusters coded together with one code
+static uint64_t mergedBits(const ContextCluster& a, const ContextCluster& b, unsigned maxCodeLength)
+{
+    ContextCluster merged;
+    for (int symbol = 0; symbol < 256; symbol++)
+    {
+        merged.counts[symbol] = a.counts[symbol] + b.counts[symbol];
+    }
+    buildCode(merged, maxCodeLength);
+    return merged.bits;
+}
+
+ContextModel::ContextModel()
+    : tableCount(0), codedBits(UINT64_MAX)
+{
+    std::memset(tableOf, 0, sizeof(tableOf));
+}
+
+void ContextModel::segment(size_t size, unsigned stream, size_t& begin, size_t& end)
+{
+    size_t perStream = (size + kStreamCount - 1) / kStreamCount;
+    begin = std::min(size, stream * perStream);
+    end = std::min(size, begin + perStream);
+}
+
+ContextModel ContextModel::build(const unsigned char* data, size_t size, unsigned maxCodeLength)
+{
+    ContextModel model;
+    if (size < kMinBlockSize)
+    {
+        return model;
+    }
+
+    // Next-byte counts per previous byte, as the streams will see them
+    std::vector<uint32_t> counts(256 * 256, 0);
+    for (unsigned stream = 0; stream < kStreamCount; stream++)
+    {
+        size_t begin, end;
+        segment(size, stream, begin, end);
+        unsigned previous = 0;
+        for (size_t i = begin; i < end; i++)
+        {
+            counts[previous * 256 + data[i]]++;
+            previous = data[i];
+        }
+    }
+
+    // The used (byte, count) pairs of every context, most frequent contexts first
+    std::vector<std::pair<uint64_t, unsigned>> contexts;
+    std::vector<std::vector<std::pair<unsigned, uint32_t>>> symbols(256);
+    for (unsigned context = 0; context < 256; context++)
+    {
+        uint64_t total = 0;
+        for (unsigned symbol = 0; symbol < 256; symbol++)
+        {
+            uint32_t count = counts[context * 256 + symbol];
+            if (count != 0)
+            {
+                symbols[context].push_back(std::make_pair(symbol, count));
+                total += count;
+            }
+        }
+        if (total != 0)
+        {
+            contexts.push_back(std::make_pair(total, context));
+        }
+    }
+    std::sort(contexts.begin(), contexts.end(), [](const std::pair<uint64_t, unsigned>& a,
+                                                   const std::pair<uint64_t, unsigned>& b)
+    {
+        return a.first > b.first || (a.first == b.first && a.second < b.second);
+    });
+
+    // Seed one cluster with each of the most frequent contexts
+    std::vector<ContextCluster> clusters(std::min<size_t>(kMaxTables, contexts.size()));
+    for (size_t k = 0; k < clusters.size(); k++)
+    {
+        std::memset(clusters[k].counts, 0, sizeof(clusters[k].counts));
+        for (const auto& entry : symbols[contexts[k].second])
+        {
+            clusters[k].counts[entry.first] = entry.second;
+        }
+        buildCode(clusters[k], maxCodeLength);
+    }
+
+    // Move every context to the code that is cheapest for it, rebuild the
+    // codes from their new members and repeat until nothing moves
+    int assigned[256];
+    std::fill(assigned, assigned + 256, -1);
+    for (unsigned round = 0; round < kAssignRounds; round++)
+    {
+        bool changed = false;
+        for (const auto& context : contexts)
+        {
+            int best = 0;
+            uint64_t bestBits = UINT64_MAX;
+            for (size_t k = 0; k < clusters.size(); k++)
+            {
+                uint64_t bits = 0;
+                for (const auto& entry : symbols[context.second])
+                {
+                    uint8_t length = clusters[k].lengths[entry.first];
+                    bits += entry.second * (length != 0 ? length : kMissingBits);
+                }
+                if (bits < bestBits)
+                {
+                    bestBits = bits;
+                    best = static_cast<int>(k);
+                }
+            }
+            changed |= assigned[context.second] != best;
+            assigned[context.second] = best;
+        }
+
+        // Rebuild the codes, dropping clusters that lost all contexts
+        std::vector<int> renumber(clusters.size(), -1);
+        std::vector<ContextCluster> rebuilt;
+        for (const auto& context : contexts)
+        {
+            int& k = renumber[assigned[context.second]];
+            if (k < 0)
+            {
+                k = static_cast<int>(rebuilt.size());
+                rebuilt.emplace_back();
+                std::memset(rebuilt.back().counts, 0, sizeof(rebuilt.back().counts));
+            }
+            assigned[context.second] = k;
+            for (const auto& entry : symbols[context.second])
+            {
+                rebuilt[k].counts[entry.first] += entry.second;
+            }
+        }
+        for (ContextCluster& cluster : rebuilt)
+        {
+            buildCode(cluster, maxCodeLength);
+        }
+        clusters.swap(rebuilt);
+        if (!changed)
+        {
+            break;
+        }
+    }
+
+    // Merge the pair of clusters whose shared code costs least extra, as
+    // long as that is less than the table the merge saves
+    size_t n = clusters.size();
+    std::vector<uint64_t> pairBits(n * n, 0);
+    for (size_t a = 0; a < n; a++)
+    {
+        for (size_t b = a + 1; b < n; b++)
+        {
+            pairBits[a * n + b] = mergedBits(clusters[a], clusters[b], maxCodeLength);
+        }
+    }
+    std::vector<bool> alive(n, true);
+    for (;;)
+    {
+        size_t bestA = 0, bestB = 0;
+        uint64_t bestExtra = kTableBits;
+        for (size_t a = 0; a < n; a++)
+        {
+            for (size_t b = a + 1; b < n; b++)
+            {
+                if (alive[a] && alive[b])
+                {
+                    uint64_t separate = clusters[a].bits + clusters[b].bits;
+                    uint64_t extra = pairBits[a * n + b] > separate ? pairBits[a * n + b] - separate : 0;
+                    if (extra < bestExtra)
+                    {
+                        bestExtra = extra;
+                        bestA = a;
+                        bestB = b;
+                    }
+                }
+            }
+        }
+        if (bestExtra >= kTableBits)
+        {
+            break;
+        }
+
+        for (int symbol = 0; symbol < 256; symbol++)
+        {
+            clusters[bestA].counts[symbol] += clusters[bestB].counts[symbol];
+        }
+        buildCode(clusters[bestA], maxCodeLength);
+        alive[bestB] = false;
+        for (const auto& context : contexts)
+        {
+            if (assigned[context.second] == static_cast<int>(bestB))
+            {
+                assigned[context.second] = static_cast<int>(bestA);
+            }
+        }
+        for (size_t k = 0; k < n; k++)
+        {
+            if (alive[k] && k != bestA)
+            {
+                size_t a = std::min(k, bestA), b = std::max(k, bestA);
+                pairBits[a * n + b] = mergedBits(clusters[a], clusters[b], maxCodeLength);
+            }
+        }
+    }
+
+    // Number the surviving clusters and fill in the model
+    std::vector<int> tableNumber(n, -1);
+    model.tableCount = 0;
+    model.codedBits = kTableBits + 8;   // context map and table count
+    for (size_t k = 0; k < n; k++)
+    {
+        if (alive[k])
+        {
+            tableNumber[k] = static_cast<int>(model.tableCount++);
+            model.codeLengths.insert(model.codeLengths.end(), clusters[k].lengths, clusters[k].lengths + 256);
+            model.codedBits += clusters[k].bits + kTableBits;
+        }
+    }
+    for (const auto& context : contexts)
+    {
+        model.tableOf[context.second] = static_cast<uint8_t>(tableNumber[assigned[context.second]]);
+    }
+    return model;
+}
+
+std::vector<unsigned char> ContextModel::encode(const unsigned char* data, size_t size,
+                                                size_t outStreamBits[kStreamCount]) const
+{
+    std::vector<HuffmanCodeTable> tables;
+    for (unsigned table = 0; table < tableCount; table++)
+    {
+        tables.push_back(HuffmanCodeTable::fromCodeLengths(&codeLengths[table * 256]));
+    }
+    const HuffmanCodeTable* byContext[256];
+    for (int context = 0; context < 256; context++)
+    {
+        byContext[context] = &tables[tableOf[context]];
+    }
+
+    std::vector<unsigned char> packed;
+    packed.reserve(static_cast<size_t>(codedBits / 8));
+    for (unsigned stream = 0; stream < kStreamCount; stream++)
+    {
+        size_t begin, end;
+        segment(size, stream, begin, end);
+        BitWriter writer(end - begin);
+        const HuffmanCodeTable* table = byContext[0];
+        for (size_t i = begin; i < end; i++)
+        {
+            unsigned char symbol = data[i];
+            writer.writeBits(table->codes[symbol], table->lengths[symbol]);
+            table = byContext[symbol];
+        }
+        outStreamBits[stream] = writer.getBitCount();
+        std::vector<unsigned char> bytes = writer.release();
+        packed.insert(packed.end(), bytes.begin(), bytes.end());
+    }
+    return packed;
+}
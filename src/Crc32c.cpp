@@ -0,0 +1,203 @@
+#include "../include/Crc32c.h"
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define CRC32C_HAVE_SSE42 1
+#include <nmmintrin.h>
+#endif
+
+// Reflected CRC-32C polynomial
+static const uint32_t kPolynomial = 0x82F63B78u;
+
+// Slicing-by-8 tables: table[k][b] is the CRC of byte b followed by k zero bytes
+struct Crc32cTables {
+    uint32_t table[8][256];
+
+    Crc32cTables()
+    {
+        for (uint32_t byte = 0; byte < 256; byte++)
+        {
+            uint32_t crc = byte;
+            for (int bit = 0; bit < 8; bit++)
+            {
+                crc = (crc >> 1) ^ (kPolynomial & (0u - (crc & 1)));
+            }
+            table[0][byte] = crc;
+        }
+        for (uint32_t byte = 0; byte < 256; byte++)
+        {
+            for (int k = 1; k < 8; k++)
+            {
+                table[k][byte] = (table[k - 1][byte] >> 8) ^ table[0][table[k - 1][byte] & 0xFF];
+            }
+        }
+    }
+};
+
+static const Crc32cTables& tables()
+{
+    static const Crc32cTables instance;
+    return instance;
+}
+
+// Portable implementation working on the inverted CRC register
+static uint32_t extendPortable(uint32_t crc, const unsigned char* data, size_t size)
+{
+    const uint32_t (*table)[256] = tables().table;
+    while (size >= 8)
+    {
+        // Little-endian words regardless of the host byte order
+        uint32_t low = data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<uint32_t>(data[3]) << 24);
+        uint32_t high = data[4] | (data[5] << 8) | (data[6] << 16) | (static_cast<uint32_t>(data[7]) << 24);
+        low ^= crc;
+        crc = table[7][low & 0xFF] ^ table[6][(low >> 8) & 0xFF] ^
+              table[5][(low >> 16) & 0xFF] ^ table[4][low >> 24] ^
+              table[3][high & 0xFF] ^ table[2][(high >> 8) & 0xFF] ^
+              table[1][(high >> 16) & 0xFF] ^ table[0][high >> 24];
+        data += 8;
+        size -= 8;
+    }
+    while (size-- > 0)
+    {
+        crc = (crc >> 8) ^ table[0][(crc ^ *data++) & 0xFF];
+    }
+    return crc;
+}
+
+#ifdef CRC32C_HAVE_SSE42
+// SSE4.2 implementation working on the inverted CRC register
+__attribute__((target("sse4.2")))
+static uint32_t extendHardware(uint32_t crc, const unsigned char* data, size_t size)
+{
+#ifdef __x86_64__
+    uint64_t crc64 = crc;
+    while (size >= 8)
+    {
+        uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+        data += 8;
+        size -= 8;
+    }
+    crc = static_cast<uint32_t>(crc64);
+#else
+    while (size >= 4)
+    {
+        uint32_t word;
+        std::memcpy(&word, data, sizeof(word));
+        crc = _mm_crc32_u32(crc, word);
+        data += 4;
+        size -= 4;
+    }
+#endif
+    while (size-- > 0)
+    {
+        crc = _mm_crc32_u8(crc, *data++);
+    }
+    return crc;
+}
+#endif
+
+typedef uint32_t (*ExtendFunction)(uint32_t, const unsigned char*, size_t);
+
+static ExtendFunction selectImplementation()
+{
+#ifdef CRC32C_HAVE_SSE42
+    if (__builtin_cpu_supports("sse4.2"))
+    {
+        return extendHardware;
+    }
+#endif
+    tables();
+    return extendPortable;
+}
+
+static ExtendFunction implementation()
+{
+    static const ExtendFunction selected = selectImplementation();
+    return selected;
+}
+
+uint32_t Crc32c::compute(const unsigned char* data, size_t size)
+{
+    return extend(0, data, size);
+}
+
+uint32_t Crc32c::extend(uint32_t crc, const unsigned char* data, size_t size)
+{
+    return ~implementation()(~crc, data, size);
+}
+
+// Multiply a 32x32 GF(2) matrix by a vector
+static uint32_t gf2MatrixTimes(const uint32_t* matrix, uint32_t vector)
+{
+    uint32_t sum = 0;
+    for (int i = 0; vector != 0; i++, vector >>= 1)
+    {
+        if (vector & 1)
+        {
+            sum ^= matrix[i];
+        }
+    }
+    return sum;
+}
+
+// Square a 32x32 GF(2) matrix
+static void gf2MatrixSquare(uint32_t* square, const uint32_t* matrix)
+{
+    for (int i = 0; i < 32; i++)
+    {
+        square[i] = gf2MatrixTimes(matrix, matrix[i]);
+    }
+}
+
+uint32_t Crc32c::combine(uint32_t crcA, uint32_t crcB, uint64_t sizeB)
+{
+    if (sizeB == 0)
+    {
+        return crcA;
+    }
+
+    // Shift crcA past sizeB zero bytes by repeated squaring of the operator
+    // that appends one zero bit, then fold in crcB
+    uint32_t even[32];
+    uint32_t odd[32];
+    odd[0] = kPolynomial;
+    for (int i = 1; i < 32; i++)
+    {
+        odd[i] = 1u << (i - 1);
+    }
+    gf2MatrixSquare(even, odd);   // two zero bits
+    gf2MatrixSquare(odd, even);   // four zero bits
+
+    do
+    {
+        gf2MatrixSquare(even, odd);
+        if (sizeB & 1)
+        {
+            crcA = gf2MatrixTimes(even, crcA);
+        }
+        sizeB >>= 1;
+        if (sizeB == 0)
+        {
+            break;
+        }
+        gf2MatrixSquare(odd, even);
+        if (sizeB & 1)
+        {
+            crcA = gf2MatrixTimes(odd, crcA);
+        }
+        sizeB >>= 1;
+    } while (sizeB != 0);
+
+    return crcA ^ crcB;
+}
+
+bool Crc32c::isHardwareAccelerated()
+{
+#ifdef CRC32C_HAVE_SSE42
+    return implementation() == extendHardware;
+#else
+    return false;
+#endif
+}
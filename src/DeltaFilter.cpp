@@ -0,0 +1,95 @@
+#include "../include/DeltaFilter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+const unsigned DeltaFilter::kMaxStride;
+const unsigned DeltaFilter::kAutoStride;
+const size_t DeltaFilter::kSampleSize;
+
+// Number of places the detection sample is taken from, spread over the block
+static const unsigned kSampleChunks = 4;
+
+void DeltaFilter::encode(const unsigned char* data, size_t size, unsigned stride, unsigned char* out)
+{
+    size_t head = std::min<size_t>(stride, size);
+    std::memcpy(out, data, head);
+    for (size_t i = head; i < size; i++)
+    {
+        out[i] = static_cast<unsigned char>(data[i] - data[i - stride]);
+    }
+}
+
+void DeltaFilter::decode(unsigned char* data, size_t size, unsigned stride)
+{
+    for (size_t i = stride; i < size; i++)
+    {
+        data[i] = static_cast<unsigned char>(data[i] + data[i - stride]);
+    }
+}
+
+// Order-0 entropy of a histogram in bits
+static double entropyBits(const uint32_t counts[256], uint32_t total)
+{
+    double bits = 0.0;
+    for (int symbol = 0; symbol < 256; symbol++)
+    {
+        if (counts[symbol] != 0)
+        {
+            bits += counts[symbol] * std::log2(static_cast<double>(total) / counts[symbol]);
+        }
+    }
+    return bits;
+}
+
+unsigned DeltaFilter::chooseStride(const unsigned char* data, size_t size, unsigned requested)
+{
+    if (size <= kMaxStride)
+    {
+        return 0;
+    }
+
+    // Sample positions: kSampleChunks runs spread evenly, each preceded by
+    // at least kMaxStride bytes so every stride has a reference byte
+    size_t chunkSize = std::min(kSampleSize / kSampleChunks, (size - kMaxStride) / kSampleChunks + 1);
+    size_t starts[kSampleChunks];
+    for (unsigned chunk = 0; chunk < kSampleChunks; chunk++)
+    {
+        starts[chunk] = kMaxStride + (size - kMaxStride - chunkSize) * chunk / kSampleChunks;
+    }
+
+    uint32_t counts[256] = {0};
+    uint32_t total = 0;
+    for (unsigned chunk = 0; chunk < kSampleChunks; chunk++)
+    {
+        for (size_t i = starts[chunk]; i < starts[chunk] + chunkSize; i++)
+        {
+            counts[data[i]]++;
+        }
+        total += static_cast<uint32_t>(chunkSize);
+    }
+    double plainBits = entropyBits(counts, total);
+
+    unsigned first = requested == kAutoStride ? 1 : requested;
+    unsigned last = requested == kAutoStride ? kMaxStride : requested;
+    unsigned best = 0;
+    double bestBits = plainBits - plainBits / 32;
+    for (unsigned stride = first; stride <= last; stride++)
+    {
+        std::memset(counts, 0, sizeof(counts));
+        for (unsigned chunk = 0; chunk < kSampleChunks; chunk++)
+        {
+            for (size_t i = starts[chunk]; i < starts[chunk] + chunkSize; i++)
+            {
+                counts[static_cast<unsigned char>(data[i] - data[i - stride])]++;
+            }
+        }
+        double bits = entropyBits(counts, total);
+        if (bits < bestBits)
+        {
+            bestBits = bits;
+            best = stride;
+        }
+    }
+    return best;
+}
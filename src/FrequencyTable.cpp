@@ -0,0 +1,110 @@
+#include "../include/FrequencyTable.h"
+#include "../include/ArchiveIO.h"
+#include "../include/HuffmanException.h"
+#include <cstring>
+#include <fstream>
+
+const unsigned char FrequencyTable::kMagic[4] = {'H', 'F', 'T', 0x1A};
+const uint16_t FrequencyTable::kVersion;
+const size_t FrequencyTable::kFileSize;
+
+FrequencyTable::FrequencyTable()
+{
+    for (int symbol = 0; symbol < 256; symbol++)
+    {
+        counts[symbol] = 0;
+    }
+}
+
+void FrequencyTable::add(const uint64_t otherCounts[256])
+{
+    for (int symbol = 0; symbol < 256; symbol++)
+    {
+        counts[symbol] += otherCounts[symbol];
+    }
+}
+
+void FrequencyTable::merge(const FrequencyTable& other)
+{
+    add(other.counts);
+}
+
+uint64_t FrequencyTable::count(unsigned char symbol) const
+{
+    return counts[symbol];
+}
+
+const uint64_t* FrequencyTable::data() const
+{
+    return counts;
+}
+
+uint64_t FrequencyTable::total() const
+{
+    uint64_t sum = 0;
+    for (int symbol = 0; symbol < 256; symbol++)
+    {
+        sum += counts[symbol];
+    }
+    return sum;
+}
+
+void FrequencyTable::save(const std::string& path) const
+{
+    ArchiveWriter out;
+    out.writeBytes(kMagic, sizeof(kMagic));
+    out.writeU16(kVersion);
+    out.writeU16(0);
+    for (int symbol = 0; symbol < 256; symbol++)
+    {
+        out.writeU64(counts[symbol]);
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw HuffmanException::fileError(path, "create");
+    }
+    out.flushTo(file);
+    if (!file)
+    {
+        throw HuffmanException::fileError(path, "write");
+    }
+}
+
+FrequencyTable FrequencyTable::load(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw HuffmanException::fileError(path, "open");
+    }
+    unsigned char bytes[kFileSize];
+    if (!file.read(reinterpret_cast<char*>(bytes), sizeof(bytes)) || file.peek() != EOF)
+    {
+        throw HuffmanException::archiveFormatError("Not a frequency table: " + path);
+    }
+
+    ArchiveReader in(bytes, sizeof(bytes));
+    if (std::memcmp(in.readBytes(sizeof(kMagic)), kMagic, sizeof(kMagic)) != 0 ||
+        in.readU16() != kVersion)
+    {
+        throw HuffmanException::archiveFormatError("Not a frequency table: " + path);
+    }
+    in.readU16();
+
+    FrequencyTable table;
+    for (int symbol = 0; symbol < 256; symbol++)
+    {
+        table.counts[symbol] = in.readU64();
+    }
+    return table;
+}
+
+bool FrequencyTable::isTableFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    unsigned char magic[sizeof(kMagic)];
+    return file.read(reinterpret_cast<char*>(magic), sizeof(magic)) &&
+           std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+}
@@ -1,177 +1,212 @@
 #include "../include/HuffmanAlgorithm.h"
-#include <queue>
+#include "../include/BitStream.h"
+#include "../include/HuffmanDecoder.h"
+#include "../include/ThreadPool.h"
+#include "../include/MappedFile.h"
+#include "../include/ArchiveIO.h"
+#include "../include/Crc32c.h"
+#include "../include/FrequencyTable.h"
+#include "../include/DeltaFilter.h"
 #include <cmath>
 #include <cstdint>
+#include <cstring>
+#include <ctime>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <vector>
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <map>
+#include <mutex>
+#include <iterator>
+#include <functional>
+#include <chrono>
+#include <iomanip>
 
-// Helper function to pack 8 bits into a single byte (adapted from old implementation)
-static unsigned char packBitsIntoByte(const std::vector<int>& bits, size_t startPos)
+// Frequency map holding the used entries of a flat byte histogram
+static std::map<char, int> frequencyMapFromCounts(const uint64_t counts[256])
 {
-    unsigned char byte = 0;
-    for (int i = 0; i < 8 && (startPos + i) < bits.size(); i++)
+    std::map<char, int> frequencies;
+    for (int symbol = 0; symbol < 256; symbol++)
     {
-        if (bits[startPos + i] == 1)
+        if (counts[symbol] != 0)
         {
-            byte |= (1 << (7 - i));  // Set bit at position (7-i)
+            frequencies.emplace_hint(frequencies.end(), static_cast<char>(symbol), 
+                                     static_cast<int>(counts[symbol] < 0x7FFFFFFF ? counts[symbol] : 0x7FFFFFFF));
         }
     }
-    return byte;
+    return frequencies;
 }
 
-// Convert bit string to actual binary data
-static std::vector<unsigned char> stringToBinaryData(const std::string& bitString)
+// Order-0 entropy in bits per byte of a histogram over total bytes
+static double entropyPerByte(const uint64_t counts[256], size_t total)
 {
-    std::vector<unsigned char> binaryData;
-    std::vector<int> bits;
-    
-    // Convert string of '0' and '1' to vector of integers
-    for (char c : bitString)
+    double entropy = 0.0;
+    for (int symbol = 0; symbol < 256 && total > 0; symbol++)
     {
-        bits.push_back(c - '0');
+        if (counts[symbol] != 0)
+        {
+            double probability = static_cast<double>(counts[symbol]) / total;
+            entropy -= probability * std::log2(probability);
+        }
     }
-    
-    // Pack bits into bytes
-    for (size_t i = 0; i < bits.size(); i += 8)
+    return entropy;
+}
+
+// Whole-archive statistics from symbol counts summed over all blocks.
+// The code table shown is the single table the whole input would use.
+// The Huffman average and efficiency cover only the blocks coded with one
+// code per block (or stored): order0Size bytes coded into order0Bits,
+// against order0Entropy, the sum of each such block's own order-0 entropy
+// in bits. Run-length, LZ77, BWT and context blocks are not order-0 codes;
+// measuring them against the order-0 entropy would report averages below
+// it and efficiencies above 100%.
+static CompressionStatistics buildArchiveStatistics(const uint64_t counts[256], size_t originalSize,
+                                                    size_t order0Size, size_t order0Bits, double order0Entropy,
+                                                    size_t compressedBytes, unsigned maxCodeLength)
+{
+    CompressionStatistics stats;
+    stats.frequencies = frequencyMapFromCounts(counts);
+    stats.huffmanCodes = HuffmanCodeTable::fromFrequencies(counts, maxCodeLength).toCodeStrings();
+    for (const auto& pair : stats.huffmanCodes)
     {
-        binaryData.push_back(packBitsIntoByte(bits, i));
+        stats.codeLengths[pair.first] = pair.second.length();
     }
     
-    return binaryData;
+    stats.totalOriginalSize = originalSize;
+    stats.totalCompressedSize = compressedBytes;
+    if (originalSize > 0)
+    {
+        stats.compressionRatio = (1.0 - static_cast<double>(compressedBytes) / originalSize) * 100.0;
+        stats.shannonInfo = entropyPerByte(counts, originalSize);
+    }
+    if (order0Size > 0 && order0Bits > 0)
+    {
+        stats.huffmanAverage = static_cast<double>(order0Bits) / order0Size;
+        stats.efficiency = order0Entropy / order0Bits * 100.0;
+    }
+    return stats;
 }
 
-// Convert binary data back to bit string (for decompression)
-static std::string binaryDataToString(const std::vector<unsigned char>& binaryData, size_t totalValidBits)
+// Local creation time recorded in archive metadata
+static std::string currentTimestamp()
 {
-    std::string bitString;
-    size_t bitCount = 0;
-    
-    for (unsigned char byte : binaryData)
+    std::time_t now = std::time(nullptr);
+    char buffer[32];
+    if (std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", std::localtime(&now)) == 0)
     {
-        for (int i = 7; i >= 0; i--)  // MSB to LSB
-        {
-            if (bitCount >= totalValidBits) break;
-            
-            if (byte & (1 << i))
-                bitString += '1';
-            else
-                bitString += '0';
-                
-            bitCount++;
-        }
-        if (bitCount >= totalValidBits) break;
+        return "";
     }
-    
-    return bitString;
+    return buffer;
 }
 
 std::map<char, int> HuffmanAlgorithm::buildFrequencyTable(const std::string& text)
 {
-    std::map<char, int> frequencies;
-    for (char ch : text)
-    {
-        frequencies[ch]++;
-    }
-    return frequencies;
+    return buildFrequencyTable(reinterpret_cast<const unsigned char*>(text.data()), text.size());
 }
 
-HuffmanNode* HuffmanAlgorithm::buildHuffmanTree(const std::map<char, int>& frequencies)
+std::map<char, int> HuffmanAlgorithm::buildFrequencyTable(const unsigned char* data, size_t size)
 {
-    // Create a priority queue (min-heap) of HuffmanNode pointers
-    std::priority_queue<HuffmanNode*, std::vector<HuffmanNode*>, NodeComparator> pq;
-    
-    // Create leaf nodes for each character and add to priority queue
-    for (const auto& pair : frequencies)
-    {
-        HuffmanNode* node = new HuffmanNode(pair.first, pair.second);
-        pq.push(node);
-    }
+    uint64_t counts[256] = {0};
+    countByteFrequencies(data, size, counts);
+    return frequencyMapFromCounts(counts);
+}
+
+void HuffmanAlgorithm::countByteFrequencies(const unsigned char* data, size_t size, uint64_t counts[256])
+{
+    const int kLanes = 8;
+    const size_t kChunkSize = size_t(1) << 30;   // keeps every 32-bit sub-counter below overflow
     
-    // Build the tree by combining nodes until only one remains
-    while (pq.size() > 1)
+    while (size > 0)
     {
-        // Get the two nodes with lowest frequency
-        HuffmanNode* left = pq.top();
-        pq.pop();
-        HuffmanNode* right = pq.top();
-        pq.pop();
+        size_t chunk = std::min(size, kChunkSize);
+        uint32_t lanes[kLanes][256] = {{0}};
+        
+        // Sixteen bytes per iteration, each byte of a word into its own lane
+        size_t i = 0;
+        for (; i + 16 <= chunk; i += 16)
+        {
+            uint64_t low;
+            uint64_t high;
+            std::memcpy(&low, data + i, sizeof(low));
+            std::memcpy(&high, data + i + 8, sizeof(high));
+            for (int lane = 0; lane < kLanes; lane++)
+            {
+                lanes[lane][(low >> (8 * lane)) & 0xFF]++;
+            }
+            for (int lane = 0; lane < kLanes; lane++)
+            {
+                lanes[lane][(high >> (8 * lane)) & 0xFF]++;
+            }
+        }
+        for (; i < chunk; i++)
+        {
+            lanes[0][data[i]]++;
+        }
         
-        // Create internal node with combined frequency
-        HuffmanNode* internal = new HuffmanNode('\0', left->getFrequency() + right->getFrequency());
-        internal->setLeft(left);
-        internal->setRight(right);
+        for (int symbol = 0; symbol < 256; symbol++)
+        {
+            uint64_t total = 0;
+            for (int lane = 0; lane < kLanes; lane++)
+            {
+                total += lanes[lane][symbol];
+            }
+            counts[symbol] += total;
+        }
         
-        // Add back to priority queue
-        pq.push(internal);
+        data += chunk;
+        size -= chunk;
     }
-    
-    // Return the root (last remaining node)
-    return pq.empty() ? nullptr : pq.top();
 }
 
-void HuffmanAlgorithm::generateCodes(HuffmanNode* root, const std::string& code, 
-                                    std::map<char, std::string>& codes)
+std::vector<unsigned char> HuffmanAlgorithm::encodeInterleaved(const unsigned char* data, size_t size,
+                                                              const HuffmanCodeTable& table,
+                                                              size_t outStreamBits[ArchiveBlock::kStreamCount])
 {
-    if (!root) 
-        return;
+    const unsigned kStreams = ArchiveBlock::kStreamCount;
     
-    // If this is a leaf node, store the code
-    if (root->isLeaf())
+    // Size every stream from its exact encoded length so none reallocates
+    size_t expectedBits[kStreams] = {0};
+    for (size_t i = 0; i < size; i++)
     {
-        codes[root->getCharacter()] = code.empty() ? "0" : code;
-        return;
+        expectedBits[i % kStreams] += table.lengths[data[i]];
     }
     
-    // Recursively generate codes for left and right subtrees
-    generateCodes(root->getLeft(), code + "0", codes);
-    generateCodes(root->getRight(), code + "1", codes);
-}
-
-std::string HuffmanAlgorithm::encodeText(const std::string& text, 
-                                        const std::map<char, std::string>& codes)
-{
-    std::string encoded;
-    for (char ch : text)
+    std::vector<BitWriter> writers;
+    writers.reserve(kStreams);
+    size_t expectedBytes = 0;
+    for (unsigned stream = 0; stream < kStreams; stream++)
     {
-        auto it = codes.find(ch);
-        if (it != codes.end())
-        {
-            encoded += it->second;
-        }
+        writers.emplace_back((expectedBits[stream] + 7) / 8);
+        expectedBytes += (expectedBits[stream] + 7) / 8;
     }
-    return encoded;
-}
-
-std::string HuffmanAlgorithm::decodeText(const std::string& encodedText, HuffmanNode* root)
-{
-    if (!root) return "";
     
-    std::string decoded;
-    HuffmanNode* current = root;
-    
-    for (char bit : encodedText)
+    size_t i = 0;
+    for (; i + kStreams <= size; i += kStreams)
     {
-        // Move left for '0', right for '1'
-        if (bit == '0')
-        {
-            current = current->getLeft();
-        }
-        else if (bit == '1')
-        {
-            current = current->getRight();
-        }
-        
-        // If we reached a leaf, add the character and reset to root
-        if (current && current->isLeaf())
+        for (unsigned stream = 0; stream < kStreams; stream++)
         {
-            decoded += current->getCharacter();
-            current = root;
+            unsigned char symbol = data[i + stream];
+            writers[stream].writeBits(table.codes[symbol], table.lengths[symbol]);
         }
     }
+    for (; i < size; i++)
+    {
+        unsigned char symbol = data[i];
+        writers[i % kStreams].writeBits(table.codes[symbol], table.lengths[symbol]);
+    }
     
-    return decoded;
+    std::vector<unsigned char> packed;
+    packed.reserve(expectedBytes);
+    for (unsigned stream = 0; stream < kStreams; stream++)
+    {
+        std::vector<unsigned char> bytes = writers[stream].release();
+        outStreamBits[stream] = writers[stream].getBitCount();
+        packed.insert(packed.end(), bytes.begin(), bytes.end());
+    }
+    return packed;
 }
 
 double HuffmanAlgorithm::calculateShannonEntropy(const std::map<char, int>& frequencies, 
@@ -191,16 +226,18 @@ double HuffmanAlgorithm::calculateShannonEntropy(const std::map<char, int>& freq
     return entropy;
 }
 
-CompressionStatistics HuffmanAlgorithm::generateCompressionStatistics(const std::string& text)
+CompressionStatistics HuffmanAlgorithm::generateCompressionStatistics(const unsigned char* data, size_t size,
+                                                                     unsigned maxCodeLength)
 {
     CompressionStatistics stats;
     
     // Build frequency table
-    stats.frequencies = buildFrequencyTable(text);
+    uint64_t counts[256] = {0};
+    countByteFrequencies(data, size, counts);
+    stats.frequencies = frequencyMapFromCounts(counts);
     
-    // Build Huffman tree and generate codes
-    HuffmanNode* tree = buildHuffmanTree(stats.frequencies);
-    generateCodes(tree, "", stats.huffmanCodes);
+    // Build canonical codes (these are the codes actually written)
+    stats.huffmanCodes = HuffmanCodeTable::fromFrequencies(counts, maxCodeLength).toCodeStrings();
     
     // Calculate code lengths
     for (const auto& pair : stats.huffmanCodes)
@@ -209,7 +246,7 @@ CompressionStatistics HuffmanAlgorithm::generateCompressionStatistics(const std:
     }
     
     // Calculate statistics
-    stats.totalOriginalSize = text.length();
+    stats.totalOriginalSize = size;
     
     // Calculate compressed size in bits
     size_t compressedBits = 0;
@@ -228,7 +265,7 @@ CompressionStatistics HuffmanAlgorithm::generateCompressionStatistics(const std:
     }
     
     // Calculate Shannon entropy
-    stats.shannonInfo = calculateShannonEntropy(stats.frequencies, text.length());
+    stats.shannonInfo = calculateShannonEntropy(stats.frequencies, static_cast<int>(size));
     
     // Calculate Huffman average bits per character
     double totalBits = 0.0;
@@ -236,7 +273,7 @@ CompressionStatistics HuffmanAlgorithm::generateCompressionStatistics(const std:
     {
         totalBits += pair.second * stats.huffmanCodes[pair.first].length();
     }
-    stats.huffmanAverage = totalBits / text.length();
+    stats.huffmanAverage = totalBits / size;
     
     // Calculate efficiency (Huffman vs Shannon)
     if (stats.huffmanAverage > 0)
@@ -244,366 +281,1555 @@ CompressionStatistics HuffmanAlgorithm::generateCompressionStatistics(const std:
         stats.efficiency = (stats.shannonInfo / stats.huffmanAverage) * 100.0;
     }
     
-    // Clean up tree memory
-    // TODO: Implement proper tree cleanup function
-    
     return stats;
 }
 
-std::string HuffmanAlgorithm::compressText(const std::string& text, 
-                                          HuffmanNode*& outTree, 
-                                          CompressionStatistics& outStats)
+// Payload bits of data with the given histogram under a code, or
+// UINT64_MAX if the code lacks a byte value that occurs
+static uint64_t estimateCodedBits(const uint64_t counts[256], const uint8_t codeLengths[256])
 {
-    // Generate compression statistics (includes frequency table and codes)
-    outStats = generateCompressionStatistics(text);
-    
-    // Build tree for output
-    outTree = buildHuffmanTree(outStats.frequencies);
-    
-    // Encode the text
-    return encodeText(text, outStats.huffmanCodes);
+    uint64_t bits = 0;
+    for (int symbol = 0; symbol < 256; symbol++)
+    {
+        if (counts[symbol] != 0)
+        {
+            if (codeLengths[symbol] == 0)
+            {
+                return UINT64_MAX;
+            }
+            bits += counts[symbol] * codeLengths[symbol];
+        }
+    }
+    return bits;
 }
 
-std::string HuffmanAlgorithm::decompressText(const std::string& encodedText, 
-                                            HuffmanNode* tree)
+// Bits a block spends on storing its own code lengths
+static const uint64_t kOwnCodeBits = 128 * 8;
+
+// A block is stored verbatim unless coding saves at least 1/kStoreDivisor
+// of its size: below that the decode cost outweighs the few bytes saved
+static const uint64_t kStoreDivisor = 32;
+
+// Runs shorter than this stay literals: a run costs a few bytes of run
+// list, and Huffman coding already spends as little as 1 bit per byte
+static const size_t kMinRunLength = 32;
+
+static void appendVarint(std::vector<unsigned char>& out, uint64_t value)
 {
-    return decodeText(encodedText, tree);
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(value));
 }
 
-bool HuffmanAlgorithm::encodeFiles(const CommandLineOptions& options)
+static uint64_t readVarint(const unsigned char*& next, const unsigned char* end)
 {
-    try {
-        if (options.isVerbose()) {
-            std::cout << "Encoding files...\n";
-        }
-        
-        // Read input files and store their content with metadata
-        std::string allText;
-        std::vector<std::pair<std::string, size_t>> fileInfo; // filename, size
-        
-        for (const std::string& inputFile : options.getInputFiles())
+    uint64_t value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7)
+    {
+        if (next == end)
         {
-            if (options.isVerbose())
-            {
-                std::cout << "Reading file: " << inputFile << "\n";
-            }
-            
-            std::ifstream file(inputFile, std::ios::binary);
-            if (!file.is_open())
-            {
-                std::cerr << "Error: Could not open file " << inputFile << "\n";
-                return false;
-            }
-            
-            std::stringstream buffer;
-            buffer << file.rdbuf();
-            std::string fileContent = buffer.str();
-            
-            // Extract just the filename without path
-            size_t lastSlash = inputFile.find_last_of("/\\");
-            std::string fileName = (lastSlash != std::string::npos) ? 
-                                   inputFile.substr(lastSlash + 1) : inputFile;
-            
-            fileInfo.push_back({fileName, fileContent.length()});
-            allText += fileContent;
-            file.close();
+            throw HuffmanException::archiveFormatError("Invalid run-length block");
         }
-        
-        if (allText.empty())
+        unsigned char byte = *next++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
         {
-            std::cerr << "Error: No content to compress\n";
-            return false;
+            return value;
         }
-        
-        // Perform Huffman compression
-        HuffmanNode* tree = nullptr;
-        CompressionStatistics stats;
-        std::string compressed = compressText(allText, tree, stats);
-        
-        // Write compressed data to output file
-        // Format: [num_files][file_info][original_total_size][frequency_table_size][frequency_table][compressed_data]
-        std::string outputFile = options.getOutputFile();
-        std::ofstream outFile(outputFile, std::ios::binary);
-        if (!outFile.is_open())
+    }
+    throw HuffmanException::archiveFormatError("Invalid run-length block");
+}
+
+// Split a block into the literals left after removing runs of at least
+// kMinRunLength equal bytes (each run keeps its first byte as a literal)
+// and the run list: per run, the literals since the previous run and the
+// number of extra repeats. Returns the number of bytes the runs remove;
+// nothing is copied when there are no runs.
+static size_t splitRuns(const unsigned char* data, size_t size, 
+                        std::vector<unsigned char>& literals, std::vector<unsigned char>& runList)
+{
+    // Every run of kMinRunLength bytes contains two equal bytes at
+    // positions p and p + kMinRunLength / 2 with p a multiple of half the
+    // minimum, so only those pairs need a closer look
+    const size_t kStride = kMinRunLength / 2;
+    std::vector<std::pair<size_t, size_t>> runs;
+    for (size_t p = 0; p + kStride < size; p += kStride)
+    {
+        if (data[p] != data[p + kStride])
         {
-            std::cerr << "Error: Could not create output file " << outputFile << "\n";
-            delete tree;
-            return false;
+            continue;
         }
-        
-        // Write number of files
-        size_t numFiles = fileInfo.size();
-        outFile.write(reinterpret_cast<const char*>(&numFiles), sizeof(numFiles));
-        
-        // Write file metadata
-        for (const auto& info : fileInfo)
+        size_t start = p;
+        while (start > 0 && data[start - 1] == data[p])
         {
-            size_t nameLength = info.first.length();
-            outFile.write(reinterpret_cast<const char*>(&nameLength), sizeof(nameLength));
-            outFile.write(info.first.c_str(), nameLength);
-            outFile.write(reinterpret_cast<const char*>(&info.second), sizeof(info.second));
+            start--;
         }
-        
-        // Write original total size
-        size_t originalSize = allText.length();
-        outFile.write(reinterpret_cast<const char*>(&originalSize), sizeof(originalSize));
-        
-        // Write frequency table
-        size_t freqTableSize = stats.frequencies.size();
-        outFile.write(reinterpret_cast<const char*>(&freqTableSize), sizeof(freqTableSize));
-        
-        for (const auto& pair : stats.frequencies)
+        size_t end = p + 1;
+        while (end < size && data[end] == data[p])
         {
-            outFile.write(&pair.first, sizeof(char));
-            outFile.write(reinterpret_cast<const char*>(&pair.second), sizeof(int));
+            end++;
         }
-        
-        // Convert bit string to actual binary data and write it
-        std::vector<unsigned char> binaryData = stringToBinaryData(compressed);
-        
-        // Update stats with actual compressed size
-        stats.totalCompressedSize = binaryData.size();
-        
-        // Write compression statistics
-        outFile.write(reinterpret_cast<const char*>(&stats.shannonInfo), sizeof(double));
-        outFile.write(reinterpret_cast<const char*>(&stats.huffmanAverage), sizeof(double));
-        outFile.write(reinterpret_cast<const char*>(&stats.compressionRatio), sizeof(double));
-        outFile.write(reinterpret_cast<const char*>(&stats.efficiency), sizeof(double));
-        outFile.write(reinterpret_cast<const char*>(&stats.totalOriginalSize), sizeof(size_t));
-        outFile.write(reinterpret_cast<const char*>(&stats.totalCompressedSize), sizeof(size_t));
-        
-        // Write the number of valid bits in the last byte (for proper decompression)
-        size_t totalBits = compressed.length();
-        unsigned char paddingBits = (8 - (totalBits % 8)) % 8;  // Number of padding bits in last byte
-        outFile.write(reinterpret_cast<const char*>(&paddingBits), sizeof(paddingBits));
-        
-        // Write the actual compressed binary data
-        outFile.write(reinterpret_cast<const char*>(binaryData.data()), binaryData.size());
-        outFile.close();
-        
-        if (options.isVerbose())
+        if (end - start >= kMinRunLength && (runs.empty() || start >= runs.back().second))
         {
-            std::cout << "Compression completed. Output written to: " << outputFile << "\n";
-            std::cout << "Files compressed: " << numFiles << "\n";
-            std::cout << "Original size: " << allText.length() << " bytes\n";
-            std::cout << "Compressed data size: " << binaryData.size() << " bytes\n";
-            std::cout << "Actual compression ratio: " << (1.0 - (double)binaryData.size() / allText.length()) * 100.0 << "%\n";
-            stats.printVerboseStatistics();
+            runs.push_back(std::make_pair(start, end));
+            p = (end - 1) / kStride * kStride;
         }
-        
-        // Clean up
-        delete tree;
-        return true;
     }
-    catch (const std::exception& e)
+    
+    size_t removed = 0;
+    size_t literalStart = 0;
+    size_t literalsAtLastRun = 0;
+    for (const std::pair<size_t, size_t>& run : runs)
     {
-        std::cerr << "Error during encoding: " << e.what() << "\n";
-        return false;
+        literals.insert(literals.end(), data + literalStart, data + run.first + 1);
+        appendVarint(runList, literals.size() - literalsAtLastRun);
+        appendVarint(runList, run.second - run.first - 1);
+        literalsAtLastRun = literals.size();
+        literalStart = run.second;
+        removed += run.second - run.first - 1;
+    }
+    if (!runs.empty())
+    {
+        literals.insert(literals.end(), data + literalStart, data + size);
     }
+    return removed;
 }
 
-bool HuffmanAlgorithm::decodeArchive(const CommandLineOptions& options)
+ArchiveBlock HuffmanAlgorithm::compressBlock(const unsigned char* data, size_t size, 
+                                             CompressionStatistics& outStats,
+                                             unsigned maxCodeLength,
+                                             const uint8_t* sharedCodeLengths,
+                                             uint8_t sharedCodeIndex,
+                                             bool runLength,
+                                             const Lz77::Parameters* lz77,
+                                             bool bwt,
+                                             bool order1,
+                                             unsigned deltaStride)
 {
-    try 
+    // With --delta, code the filtered bytes when the filter makes the
+    // block clearly more compressible; filtered data is never stored
+    if (deltaStride != 0)
     {
-        if (options.isVerbose()) 
-        {
-            std::cout << "Decoding archive: " << options.getInputFiles()[0] << "\n";
-        }
-        
-        // Read compressed file
-        std::string inputFile = options.getInputFiles()[0];
-        std::ifstream file(inputFile, std::ios::binary);
-        if (!file.is_open())
-        {
-            std::cerr << "Error: Could not open archive file " << inputFile << "\n";
-            return false;
-        }
-        
-        // Read number of files
-        size_t numFiles;
-        file.read(reinterpret_cast<char*>(&numFiles), sizeof(numFiles));
-        
-        // Read file metadata
-        std::vector<std::pair<std::string, size_t>> fileInfo;
-        for (size_t i = 0; i < numFiles; i++)
+        unsigned stride = DeltaFilter::chooseStride(data, size, deltaStride);
+        if (stride != 0)
         {
-            size_t nameLength;
-            file.read(reinterpret_cast<char*>(&nameLength), sizeof(nameLength));
-            
-            std::string fileName(nameLength, '\0');
-            file.read(&fileName[0], nameLength);
-            
-            size_t fileSize;
-            file.read(reinterpret_cast<char*>(&fileSize), sizeof(fileSize));
-            
-            fileInfo.push_back({fileName, fileSize});
-        }
-        
-        // Read original total size
-        size_t originalSize;
-        file.read(reinterpret_cast<char*>(&originalSize), sizeof(originalSize));
-        
-        // Read frequency table
-        size_t freqTableSize;
-        file.read(reinterpret_cast<char*>(&freqTableSize), sizeof(freqTableSize));
-        
-        std::map<char, int> frequencies;
-        for (size_t i = 0; i < freqTableSize; i++)
-        {
-            char ch;
-            int freq;
-            file.read(&ch, sizeof(char));
-            file.read(reinterpret_cast<char*>(&freq), sizeof(int));
-            frequencies[ch] = freq;
-        }
-        
-        // Read stored compression statistics
-        CompressionStatistics storedStats;
-        file.read(reinterpret_cast<char*>(&storedStats.shannonInfo), sizeof(double));
-        file.read(reinterpret_cast<char*>(&storedStats.huffmanAverage), sizeof(double));
-        file.read(reinterpret_cast<char*>(&storedStats.compressionRatio), sizeof(double));
-        file.read(reinterpret_cast<char*>(&storedStats.efficiency), sizeof(double));
-        file.read(reinterpret_cast<char*>(&storedStats.totalOriginalSize), sizeof(size_t));
-        file.read(reinterpret_cast<char*>(&storedStats.totalCompressedSize), sizeof(size_t));
-        storedStats.frequencies = frequencies;
-        
-        // Read padding bits information
-        unsigned char paddingBits;
-        file.read(reinterpret_cast<char*>(&paddingBits), sizeof(paddingBits));
-        
-        // Read the remaining binary data
-        std::vector<unsigned char> binaryData;
-        unsigned char byte;
-        while (file.read(reinterpret_cast<char*>(&byte), sizeof(byte)))
-        {
-            binaryData.push_back(byte);
-        }
-        file.close();
-        
-        if (binaryData.empty())
-        {
-            std::cerr << "Error: No compressed data found\n";
-            return false;
-        }
-        
-        // Convert binary data back to bit string
-        size_t totalBits = binaryData.size() * 8 - paddingBits;
-        std::string compressedData = binaryDataToString(binaryData, totalBits);
-
-        if (options.isVerbose())
-        {
-            std::cout << "Reconstructing Huffman tree from frequency table...\n";
-            std::cout << "Original total size: " << originalSize << " bytes\n";
-            std::cout << "Number of files: " << numFiles << "\n";
-            std::cout << "Frequency table entries: " << freqTableSize << "\n";
-            std::cout << "Compressed data: " << binaryData.size() << " bytes (" << totalBits << " bits)\n";
-            
-            // Generate Huffman codes for complete statistics display
-            HuffmanNode* tempTree = buildHuffmanTree(frequencies);
-            if (tempTree) {
-                generateCodes(tempTree, "", storedStats.huffmanCodes);
-                
-                // Calculate code lengths
-                for (const auto& pair : storedStats.huffmanCodes) {
-                    storedStats.codeLengths[pair.first] = pair.second.length();
-                }
-                
-                // Print the stored statistics
-                storedStats.printVerboseStatistics();
-                
-                // Clean up temporary tree
-                delete tempTree;
+            std::vector<unsigned char> filtered(size);
+            DeltaFilter::encode(data, size, stride, filtered.data());
+            ArchiveBlock block = compressBlock(filtered.data(), size, outStats, maxCodeLength, sharedCodeLengths, 
+                                               sharedCodeIndex, runLength, lz77, bwt, order1);
+            if (block.mode != ArchiveBlock::Stored)
+            {
+                block.deltaStride = stride;
+                block.checksum = Crc32c::compute(data, size);
+                return block;
             }
         }
-        
-        // Reconstruct Huffman tree
-        HuffmanNode* tree = buildHuffmanTree(frequencies);
-        if (!tree)
+    }
+    
+    // Codes come straight from the counts; no tree is built for a block
+    ArchiveBlock block;
+    outStats = generateCompressionStatistics(data, size, maxCodeLength);
+    block.originalSize = size;
+    block.literalCount = size;
+    block.checksum = Crc32c::compute(data, size);
+    for (const auto& pair : outStats.codeLengths)
+    {
+        block.codeLengths[static_cast<unsigned char>(pair.first)] = static_cast<uint8_t>(pair.second);
+    }
+    
+    uint64_t counts[256] = {0};
+    for (const auto& pair : outStats.frequencies)
+    {
+        counts[static_cast<unsigned char>(pair.first)] = static_cast<uint64_t>(pair.second);
+    }
+    uint64_t codedBits = estimateCodedBits(counts, block.codeLengths) + kOwnCodeBits;
+    
+    // Use the shared code if it covers the block and costs no more than
+    // the block's own code together with its stored lengths
+    if (sharedCodeLengths != nullptr)
+    {
+        uint64_t sharedBits = estimateCodedBits(counts, sharedCodeLengths);
+        if (sharedBits != UINT64_MAX && sharedBits <= codedBits)
         {
-            std::cerr << "Error: Could not reconstruct Huffman tree\n";
-            return false;
+            std::memcpy(block.codeLengths, sharedCodeLengths, sizeof(block.codeLengths));
+            block.codeTable = sharedCodeIndex;
+            codedBits = sharedBits;
         }
-        
-        // Decompress all data
-        std::string allDecompressed = decompressText(compressedData, tree);
-        
-        if (allDecompressed.length() != originalSize)
+    }
+    
+    uint64_t codedBytes = (codedBits + 7) / 8 + ArchiveBlock::kStreamCount * 8 + 1;
+    
+    // With --order1, code by previous-byte context when the extra tables
+    // pay for themselves
+    ContextModel contextModel;
+    if (order1)
+    {
+        contextModel = ContextModel::build(data, size, maxCodeLength);
+        if (contextModel.codedBits != UINT64_MAX)
         {
-            std::cerr << "Warning: Decompressed size (" << allDecompressed.length() 
-                      << ") doesn't match expected size (" << originalSize << ")\n";
+            uint64_t contextBytes = (contextModel.codedBits + 7) / 8 + ArchiveBlock::kStreamCount * 8 + 1;
+            if (contextBytes < codedBytes)
+            {
+                codedBytes = contextBytes;
+            }
+            else
+            {
+                contextModel = ContextModel();
+            }
         }
-        
-        // If output directory is specified, restore files to that directory
-        std::string outputDir = options.getOutputFile();
-        if (outputDir.empty())
+    }
+    
+    // With --method lz77, keep the LZ77 payload if it beats plain coding
+    // and saves enough to be worth its slower decode
+    if (lz77 != nullptr)
+    {
+        std::vector<unsigned char> packed = Lz77::compress(data, size, *lz77, maxCodeLength);
+        if (packed.size() + 4 < codedBytes && packed.size() + 4 <= size - size / kStoreDivisor)
         {
-            outputDir = "decompressed"; // Default directory
+            block.mode = ArchiveBlock::Lz77;
+            block.codeTable = ArchiveBlock::kOwnCode;
+            block.packedSize = packed.size();
+            block.payload.swap(packed);
+            return block;
         }
-        
-        // Create output directory if it doesn't exist
-        // Note: This is a simplified approach. In a full implementation, 
-        // you'd use proper cross-platform directory creation
-        std::string createDirCmd = "mkdir \"" + outputDir + "\" 2>nul"; // Windows
-        system(createDirCmd.c_str());
-        
-        if (options.isVerbose())
+    }
+    
+    // With --method bwt, likewise for the Burrows-Wheeler payload
+    if (bwt)
+    {
+        std::vector<unsigned char> packed = Bwt::compress(data, size, maxCodeLength);
+        if (packed.size() + 4 < codedBytes && packed.size() + 4 <= size - size / kStoreDivisor)
         {
-            std::cout << "Decompressing files to directory: " << outputDir << "\n";
+            block.mode = ArchiveBlock::Bwt;
+            block.codeTable = ArchiveBlock::kOwnCode;
+            block.packedSize = packed.size();
+            block.payload.swap(packed);
+            return block;
         }
-        
-        // Restore individual files with their original names in the output directory
-        size_t currentPos = 0;
-        for (size_t i = 0; i < numFiles; i++)
+    }
+    
+    // With --rle, code only the literals left around long runs when that
+    // is smaller than coding every byte
+    if (runLength)
+    {
+        std::vector<unsigned char> literals;
+        std::vector<unsigned char> runList;
+        if (splitRuns(data, size, literals, runList) > 0)
         {
-            const std::string& fileName = fileInfo[i].first;
-            size_t fileSize = fileInfo[i].second;
-            
-            if (currentPos + fileSize > allDecompressed.length())
-            {
-                std::cerr << "Error: Not enough decompressed data for file " << fileName << "\n";
-                delete tree;
-                return false;
-            }
-            
-            std::string fileContent = allDecompressed.substr(currentPos, fileSize);
-            currentPos += fileSize;
-            
-            // Create full path in output directory
-            std::string fullPath = outputDir + "/" + fileName;
-            
-            std::ofstream outFile(fullPath, std::ios::binary);
-            if (!outFile.is_open())
-            {
-                std::cerr << "Error: Could not create output file " << fullPath << "\n";
-                std::cerr << "Make sure the directory '" << outputDir << "' exists and is writable.\n";
-                delete tree;
-                return false;
-            }
-            
-            outFile << fileContent;
-            outFile.close();
-            
-            if (options.isVerbose())
+            uint64_t literalCounts[256] = {0};
+            countByteFrequencies(literals.data(), literals.size(), literalCounts);
+            HuffmanCodeTable literalCode = HuffmanCodeTable::fromFrequencies(literalCounts, maxCodeLength);
+            uint64_t runLengthBytes = (estimateCodedBits(literalCounts, literalCode.lengths) + kOwnCodeBits + 7) / 8 + 
+                                      runList.size() + ArchiveBlock::kStreamCount * 8 + 9;
+            if (runLengthBytes < codedBytes)
             {
-                std::cout << "Restored file: " << fullPath << " (" << fileSize << " bytes)\n";
+                block.mode = ArchiveBlock::RunLength;
+                block.codeTable = ArchiveBlock::kOwnCode;
+                block.literalCount = literals.size();
+                block.runListSize = runList.size();
+                std::memcpy(block.codeLengths, literalCode.lengths, sizeof(block.codeLengths));
+                block.payload = runList;
+                std::vector<unsigned char> streams = encodeInterleaved(literals.data(), literals.size(), 
+                                                                       literalCode, block.streamBits);
+                block.payload.insert(block.payload.end(), streams.begin(), streams.end());
+                return block;
             }
         }
-        
-        if (options.isVerbose())
-        {
-            std::cout << "Decoding completed successfully!\n";
-            std::cout << "Size verification: " << allDecompressed.length() << " bytes\n";
-        }
-        
-        // Clean up
-        delete tree;
-        return true;
     }
-    catch (const std::exception& e)
+    
+    // Near 8 bits per byte (compressed or encrypted data) the block is
+    // stored as it is, skipping the encode now and the decode later
+    if (codedBytes > size - size / kStoreDivisor)
     {
-        std::cerr << "Error during decoding: " << e.what() << "\n";
-        return false;
+        block.mode = ArchiveBlock::Stored;
+        block.codeTable = ArchiveBlock::kOwnCode;
+        block.payload.assign(data, data + size);
+        return block;
+    }
+    
+    if (contextModel.tableCount > 0)
+    {
+        block.mode = ArchiveBlock::Context;
+        block.codeTable = ArchiveBlock::kOwnCode;
+        block.tableCount = contextModel.tableCount;
+        std::memcpy(block.tableOf, contextModel.tableOf, sizeof(block.tableOf));
+        block.contextLengths = contextModel.codeLengths;
+        block.payload = contextModel.encode(data, size, block.streamBits);
+        return block;
+    }
+    
+    HuffmanCodeTable table = HuffmanCodeTable::fromCodeLengths(block.codeLengths);
+    block.payload = encodeInterleaved(data, size, table, block.streamBits);
+    return block;
+}
+
+// Decode a block's payload into out, leaving any delta filter in place
+static void decodeBlockBytes(const ArchiveBlock& block, unsigned char* out)
+{
+    if (block.mode == ArchiveBlock::Stored)
+    {
+        std::memcpy(out, block.payloadData(), block.originalSize);
+        return;
+    }
+    if (block.mode == ArchiveBlock::Lz77)
+    {
+        Lz77::decompress(block.payloadData(), block.payloadSize(), out, block.originalSize);
+        return;
+    }
+    if (block.mode == ArchiveBlock::Bwt)
+    {
+        Bwt::decompress(block.payloadData(), block.payloadSize(), out, block.originalSize);
+        return;
+    }
+    
+    const unsigned char* streams[ArchiveBlock::kStreamCount];
+    size_t sizes[ArchiveBlock::kStreamCount];
+    const unsigned char* next = block.payloadData() + block.runListSize;
+    for (unsigned stream = 0; stream < ArchiveBlock::kStreamCount; stream++)
+    {
+        streams[stream] = next;
+        sizes[stream] = block.streamSize(stream);
+        next += sizes[stream];
+    }
+    
+    if (block.mode == ArchiveBlock::Context)
+    {
+        // One table width for all decoders, so a table switch is a pointer load
+        unsigned tableBits = 0;
+        for (uint8_t length : block.contextLengths)
+        {
+            tableBits = std::max<unsigned>(tableBits, length);
+        }
+        std::vector<HuffmanDecoder> decoders;
+        for (unsigned table = 0; table < block.tableCount; table++)
+        {
+            decoders.emplace_back(HuffmanCodeTable::fromCodeLengths(&block.contextLengths[table * 256]), tableBits);
+        }
+        HuffmanDecoder::decodeContexts(decoders, block.tableOf, streams, sizes, block.streamBits, 
+                                       out, block.originalSize);
+        return;
+    }
+    
+    HuffmanDecoder decoder(HuffmanCodeTable::fromCodeLengths(block.codeLengths));
+    static_assert(ArchiveBlock::kStreamCount == HuffmanDecoder::kInterleavedStreams,
+                  "block layout and decoder must agree on the number of streams");
+    
+    // Literals are decoded into the end of the output, then expanded
+    // forward in place; the write position never passes the next literal
+    const unsigned char* runList = block.payloadData();
+    const unsigned char* runListEnd = runList + block.runListSize;
+    unsigned char* literals = out + block.originalSize - block.literalCount;
+    decoder.decodeInterleaved(streams, sizes, block.streamBits, literals, block.literalCount);
+    if (block.mode != ArchiveBlock::RunLength)
+    {
+        return;
+    }
+    
+    unsigned char* write = out;
+    unsigned char* end = out + block.originalSize;
+    size_t remaining = block.literalCount;
+    while (runList != runListEnd)
+    {
+        uint64_t count = readVarint(runList, runListEnd);
+        uint64_t repeats = readVarint(runList, runListEnd);
+        if (count == 0 || count > remaining || 
+            repeats > static_cast<uint64_t>(end - write) - remaining)
+        {
+            throw HuffmanException::archiveFormatError("Invalid run-length block");
+        }
+        std::memmove(write, literals, count);
+        write += count;
+        literals += count;
+        remaining -= count;
+        std::memset(write, write[-1], repeats);
+        write += repeats;
+    }
+    if (static_cast<size_t>(end - write) != remaining)
+    {
+        throw HuffmanException::archiveFormatError("Invalid run-length block");
+    }
+    std::memmove(write, literals, remaining);
+}
+
+void HuffmanAlgorithm::decompressBlock(const ArchiveBlock& block, unsigned char* out)
+{
+    decodeBlockBytes(block, out);
+    if (block.deltaStride != 0)
+    {
+        DeltaFilter::decode(out, block.originalSize, block.deltaStride);
+    }
+}
+
+// Collect the input files, or with --shard I/N only the pieces of them in
+// shard I: the inputs are treated as one concatenated byte stream cut into
+// N nearly equal parts. A piece keeps its file's name and records its
+// offset within the file, so decoding the concatenated shard archives joins
+// the pieces again. rangeStarts receives the offset of each piece.
+static void collectInputs(const CommandLineOptions& options, const std::vector<std::string>& paths,
+                          std::vector<FileEntry>& entries, std::vector<size_t>& rangeStarts)
+{
+    std::vector<size_t> sizes;
+    uint64_t total = 0;
+    for (const std::string& path : paths)
+    {
+        if (options.isVerbose())
+        {
+            std::cout << "Reading file: " << path << "\n";
+        }
+        
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open())
+        {
+            throw HuffmanException::fileError(path, "open");
+        }
+        sizes.push_back(static_cast<size_t>(file.tellg()));
+        total += sizes.back();
+    }
+    
+    // Shard boundaries, floor(total * i / count) without overflowing
+    uint64_t index = options.getShardIndex();
+    uint64_t count = options.getShardCount();
+    uint64_t shardStart = (total / count) * index + (total % count) * index / count;
+    uint64_t shardEnd = (total / count) * (index + 1) + (total % count) * (index + 1) / count;
+    bool lastShard = index + 1 == count;
+    
+    uint64_t fileStart = 0;
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        uint64_t fileEnd = fileStart + sizes[i];
+        uint64_t pieceStart = std::max(fileStart, shardStart);
+        uint64_t pieceEnd = std::min(fileEnd, shardEnd);
+        
+        // Empty files go to the shard holding their position (the last shard at the very end)
+        bool included = sizes[i] > 0 ? pieceStart < pieceEnd
+                                     : (shardStart <= fileStart && fileStart < shardEnd) ||
+                                       (lastShard && fileStart == total);
+        if (included)
+        {
+            // Extract just the filename without path
+            const std::string& path = paths[i];
+            size_t lastSlash = path.find_last_of("/\\");
+            std::string fileName = (lastSlash != std::string::npos) ? path.substr(lastSlash + 1) : path;
+            
+            size_t pieceSize = sizes[i] > 0 ? static_cast<size_t>(pieceEnd - pieceStart) : 0;
+            entries.push_back(FileEntry(fileName, path, pieceSize));
+            rangeStarts.push_back(sizes[i] > 0 ? static_cast<size_t>(pieceStart - fileStart) : 0);
+            entries.back().pieceOffset = rangeStarts.back();
+        }
+        fileStart = fileEnd;
+    }
+}
+
+// Add the byte counts of size bytes of a file, starting at rangeStart
+static void countFileRange(const std::string& path, size_t rangeStart, size_t size, uint64_t counts[256])
+{
+    MappedFile mapping(path, true);
+    if (mapping.isMapped())
+    {
+        if (mapping.size() < rangeStart + size)
+        {
+            throw HuffmanException::fileError(path, "read (file changed size)");
+        }
+        HuffmanAlgorithm::countByteFrequencies(mapping.data() + rangeStart, size, counts);
+        return;
+    }
+    
+    std::ifstream input(path, std::ios::binary);
+    if (!input.is_open() || !input.seekg(rangeStart))
+    {
+        throw HuffmanException::fileError(path, "open");
+    }
+    std::vector<unsigned char> buffer(std::min<size_t>(size, CommandLineOptions::kDefaultBlockSize));
+    for (size_t done = 0; done < size; )
+    {
+        size_t chunk = std::min(buffer.size(), size - done);
+        if (!input.read(reinterpret_cast<char*>(buffer.data()), chunk))
+        {
+            throw HuffmanException::fileError(path, "read");
+        }
+        HuffmanAlgorithm::countByteFrequencies(buffer.data(), chunk, counts);
+        done += chunk;
+    }
+}
+
+// Files whose blocks are at most this large are considered for a shared
+// code: below it the 128 bytes of a block's own code lengths start to show
+static const size_t kSharedCodeBlockLimit = 64 * 1024;
+
+// Decide which files should share one code. Every candidate file's cost
+// under the shared code built from the group's combined histogram is
+// compared with its cost under a private code plus the code lengths each
+// of its blocks would store; files that do better alone leave the group and
+// the shared code is rebuilt from the rest. shared[] receives the code and
+// inGroup marks its users; returns false when sharing would not pay for
+// storing the shared table itself.
+static bool chooseSharedCode(const std::vector<std::vector<uint64_t>>& histograms,
+                             const std::vector<size_t>& blockCounts, unsigned maxCodeLength,
+                             uint8_t shared[256], std::vector<bool>& inGroup)
+{
+    size_t fileCount = histograms.size();
+    std::vector<uint64_t> privateBits(fileCount);
+    for (size_t i = 0; i < fileCount; i++)
+    {
+        HuffmanCodeTable own = HuffmanCodeTable::fromFrequencies(histograms[i].data(), maxCodeLength);
+        privateBits[i] = estimateCodedBits(histograms[i].data(), own.lengths) + kOwnCodeBits * blockCounts[i];
+    }
+    
+    inGroup.assign(fileCount, true);
+    const int kMaxRounds = 4;
+    for (int round = 0; round < kMaxRounds; round++)
+    {
+        uint64_t combined[256] = {0};
+        for (size_t i = 0; i < fileCount; i++)
+        {
+            for (int symbol = 0; inGroup[i] && symbol < 256; symbol++)
+            {
+                combined[symbol] += histograms[i][symbol];
+            }
+        }
+        HuffmanCodeTable code = HuffmanCodeTable::fromFrequencies(combined, maxCodeLength);
+        std::memcpy(shared, code.lengths, 256);
+        
+        bool changed = false;
+        for (size_t i = 0; i < fileCount; i++)
+        {
+            bool better = estimateCodedBits(histograms[i].data(), shared) < privateBits[i];
+            changed = changed || (better != inGroup[i]);
+            inGroup[i] = better;
+        }
+        if (!changed)
+        {
+            break;
+        }
+    }
+    
+    // The files leaving the group may have changed the code; judge the final one
+    uint64_t saved = 0;
+    for (size_t i = 0; i < fileCount; i++)
+    {
+        uint64_t bits = estimateCodedBits(histograms[i].data(), shared);
+        inGroup[i] = bits < privateBits[i];
+        saved += inGroup[i] ? privateBits[i] - bits : 0;
+    }
+    return saved > kOwnCodeBits;
+}
+
+bool HuffmanAlgorithm::encodeFiles(const CommandLineOptions& options)
+{
+    try {
+        if (options.isVerbose()) {
+            std::cout << "Encoding files...\n";
+        }
+        
+        // Collect file names and sizes; contents are streamed block by block below
+        const std::vector<std::string>& inputFiles = options.getInputFiles();
+        std::vector<FileEntry> fileEntries;
+        std::vector<size_t> rangeStarts;
+        collectInputs(options, inputFiles, fileEntries, rangeStarts);
+        size_t originalSize = 0;
+        for (const FileEntry& entry : fileEntries)
+        {
+            originalSize += entry.originalSize;
+        }
+        
+        // A shard may legitimately be empty; a whole input may not
+        if (originalSize == 0 && options.getShardCount() == 1)
+        {
+            std::cerr << "Error: No content to compress\n";
+            return false;
+        }
+        
+        size_t numFiles = fileEntries.size();
+        size_t blockSize = options.getBlockSize();
+        unsigned maxCodeLength = options.getMaxCodeLength();
+        
+        // Everything that can reject the input is checked before the output
+        // file is opened, so a failed run never truncates an existing archive
+        if (numFiles > 0xFFFFFFFFu)
+        {
+            throw HuffmanException::compressionError("Too many input files");
+        }
+        
+        // Blocks use either their own code or a shared code stored once in
+        // the archive: the one given by --code-from, or else one built for
+        // the files with small blocks whose estimated cost goes down with it
+        SharedCodeTables sharedCodes;
+        std::vector<bool> usesSharedCode(numFiles, false);
+        size_t sharingFiles = 0;
+        if (!options.getCodeTableFile().empty())
+        {
+            FrequencyTable table = FrequencyTable::load(options.getCodeTableFile());
+            sharedCodes.add(HuffmanCodeTable::fromFrequencies(table.data(), maxCodeLength).lengths);
+            usesSharedCode.assign(numFiles, true);
+            sharingFiles = numFiles;
+        }
+        else
+        {
+            std::vector<size_t> candidates;
+            std::vector<std::vector<uint64_t>> histograms;
+            std::vector<size_t> blockCounts;
+            for (size_t fileIndex = 0; fileIndex < numFiles; fileIndex++)
+            {
+                size_t fileSize = fileEntries[fileIndex].originalSize;
+                if (fileSize > 0 && std::min(fileSize, blockSize) <= kSharedCodeBlockLimit)
+                {
+                    candidates.push_back(fileIndex);
+                    histograms.push_back(std::vector<uint64_t>(256, 0));
+                    countFileRange(fileEntries[fileIndex].relativePath, rangeStarts[fileIndex], fileSize, 
+                                   histograms.back().data());
+                    blockCounts.push_back((fileSize + blockSize - 1) / blockSize);
+                }
+            }
+            
+            uint8_t shared[256];
+            std::vector<bool> inGroup;
+            if (!candidates.empty() && chooseSharedCode(histograms, blockCounts, maxCodeLength, shared, inGroup))
+            {
+                sharedCodes.add(shared);
+                for (size_t i = 0; i < candidates.size(); i++)
+                {
+                    usesSharedCode[candidates[i]] = inGroup[i];
+                    sharingFiles += inGroup[i];
+                }
+            }
+        }
+        
+        // Write compressed data to output file
+        // Format: [header][blocks...][block_index][metadata]; the header is
+        // rewritten at the end once every section's location is known
+        std::string outputFile = options.getOutputFile();
+        std::ofstream outFile(outputFile, std::ios::binary);
+        if (!outFile.is_open())
+        {
+            std::cerr << "Error: Could not create output file " << outputFile << "\n";
+            return false;
+        }
+        
+        ArchiveHeader header;
+        header.blockSize = static_cast<uint32_t>(blockSize);
+        header.fileCount = static_cast<uint32_t>(numFiles);
+        header.originalSize = originalSize;
+        ArchiveWriter record;
+        header.writeTo(record);
+        sharedCodes.writeTo(record);
+        size_t blocksStart = record.size();
+        header.sections[ArchiveHeader::CodeTables].offset = ArchiveHeader::kSize;
+        header.sections[ArchiveHeader::CodeTables].length = blocksStart - ArchiveHeader::kSize;
+        record.flushTo(outFile);
+        
+        // Stream every input through block buffers. Each file starts a new
+        // block, so any member can later be decoded on its own. Blocks are
+        // compressed on the thread pool and written strictly in input order,
+        // so the archive is identical for every thread count.
+        uint64_t counts[256] = {0};
+        size_t order0Size = 0;
+        size_t order0Bits = 0;
+        double order0Entropy = 0.0;
+        size_t compressedBytes = 0;
+        size_t numBlocks = 0;
+        size_t sharedCodeBlocks = 0;
+        size_t storedBlocks = 0;
+        size_t runLengthBlocks = 0;
+        size_t lz77Blocks = 0;
+        size_t bwtBlocks = 0;
+        size_t contextBlocks = 0;
+        size_t deltaBlocks = 0;
+        std::vector<BlockIndexEntry> blockIndex;
+        
+        // With --method lz77 every block also goes through the match finder
+        Lz77::Parameters lz77Parameters;
+        lz77Parameters.level = options.getLevel();
+        lz77Parameters.window = options.getWindowSize();
+        const Lz77::Parameters* lz77 = 
+            options.getMethod() == CompressionMethod::Lz77 ? &lz77Parameters : nullptr;
+        bool bwt = options.getMethod() == CompressionMethod::Bwt;
+        bool order1 = options.isOrder1Enabled();
+        unsigned deltaStride = options.getDeltaStride();
+        
+        // A block either points straight into an input file's mapping or,
+        // when the file cannot be mapped, owns a copy read from a stream
+        struct BlockJob {
+            size_t fileIndex;
+            std::shared_ptr<MappedFile> source;
+            const unsigned char* data;
+            size_t size;
+            std::string owned;
+            CompressionStatistics stats;
+            ArchiveBlock block;
+        };
+        ThreadPool pool(options.getThreadCount());
+        std::deque<std::pair<std::shared_ptr<BlockJob>, std::future<void>>> inFlight;
+        const size_t maxInFlight = 2 * pool.getThreadCount();
+        
+        // Write the oldest finished block and fold it into the totals
+        auto writeOldestBlock = [&]()
+        {
+            std::shared_ptr<BlockJob> job = inFlight.front().first;
+            inFlight.front().second.get();
+            inFlight.pop_front();
+            
+            BlockIndexEntry entry;
+            entry.archiveOffset = static_cast<size_t>(outFile.tellp());
+            entry.originalSize = job->block.originalSize;
+            blockIndex.push_back(entry);
+            
+            job->block.writeTo(outFile);
+            FileEntry& file = fileEntries[job->fileIndex];
+            file.checksum = Crc32c::combine(file.checksum, job->block.checksum, job->block.originalSize);
+            uint64_t blockCounts[256] = {0};
+            for (const auto& pair : job->stats.frequencies)
+            {
+                blockCounts[static_cast<unsigned char>(pair.first)] = pair.second;
+                counts[static_cast<unsigned char>(pair.first)] += pair.second;
+            }
+            if (job->block.mode == ArchiveBlock::Coded || job->block.mode == ArchiveBlock::Stored)
+            {
+                order0Size += job->block.originalSize;
+                order0Bits += job->block.totalBits();
+                order0Entropy += entropyPerByte(blockCounts, job->block.originalSize) * job->block.originalSize;
+            }
+            compressedBytes += job->block.payloadSize();
+            sharedCodeBlocks += job->block.codeTable != ArchiveBlock::kOwnCode;
+            storedBlocks += job->block.mode == ArchiveBlock::Stored;
+            runLengthBlocks += job->block.mode == ArchiveBlock::RunLength;
+            lz77Blocks += job->block.mode == ArchiveBlock::Lz77;
+            bwtBlocks += job->block.mode == ArchiveBlock::Bwt;
+            contextBlocks += job->block.mode == ArchiveBlock::Context;
+            deltaBlocks += job->block.deltaStride != 0;
+            numBlocks++;
+        };
+        
+        std::vector<size_t> firstBlock;
+        for (size_t fileIndex = 0; fileIndex < numFiles; fileIndex++)
+        {
+            // Map the input; fall back to stream reads if it cannot be mapped
+            const std::string& path = fileEntries[fileIndex].relativePath;
+            size_t rangeStart = rangeStarts[fileIndex];
+            size_t fileSize = fileEntries[fileIndex].originalSize;
+            std::shared_ptr<MappedFile> mapping = std::make_shared<MappedFile>(path, true);
+            const uint8_t* sharedCode = usesSharedCode[fileIndex] ? sharedCodes.table(0) : nullptr;
+            bool runLength = options.isRunLengthEnabled();
+            std::ifstream input;
+            if (!mapping->isMapped())
+            {
+                input.open(path, std::ios::binary);
+                if (!input.is_open() || !input.seekg(rangeStart))
+                {
+                    throw HuffmanException::fileError(path, "open");
+                }
+            }
+            else if (mapping->size() < rangeStart + fileSize)
+            {
+                throw HuffmanException::fileError(path, "read (file changed size)");
+            }
+            
+            firstBlock.push_back(blockIndex.size() + inFlight.size());
+            for (size_t offsetInFile = 0; offsetInFile < fileSize; offsetInFile += blockSize)
+            {
+                std::shared_ptr<BlockJob> job = std::make_shared<BlockJob>();
+                job->fileIndex = fileIndex;
+                job->size = std::min(blockSize, fileSize - offsetInFile);
+                if (mapping->isMapped())
+                {
+                    job->source = mapping;
+                    job->data = mapping->data() + rangeStart + offsetInFile;
+                }
+                else
+                {
+                    job->owned.resize(job->size);
+                    if (!input.read(&job->owned[0], job->size))
+                    {
+                        throw HuffmanException::fileError(path, "read");
+                    }
+                    job->data = reinterpret_cast<const unsigned char*>(job->owned.data());
+                }
+                
+                // Bound memory: at most two blocks per thread are read ahead
+                if (inFlight.size() >= maxInFlight)
+                {
+                    writeOldestBlock();
+                }
+                std::future<void> done = pool.submit([job, maxCodeLength, sharedCode, runLength, lz77, bwt, order1, 
+                                                      deltaStride]()
+                {
+                    job->block = compressBlock(job->data, job->size, job->stats, maxCodeLength, 
+                                               sharedCode, 0, runLength, lz77, bwt, order1, deltaStride);
+                    job->owned = std::string();
+                    if (job->source)
+                    {
+                        job->source->release(job->data - job->source->data(), job->size);
+                        job->source.reset();
+                    }
+                });
+                inFlight.push_back(std::make_pair(job, std::move(done)));
+            }
+        }
+        
+        while (!inFlight.empty())
+        {
+            writeOldestBlock();
+        }
+        
+        CompressionStatistics stats = buildArchiveStatistics(counts, originalSize, order0Size, order0Bits, 
+                                                             order0Entropy, compressedBytes, maxCodeLength);
+        
+        size_t blocksEnd = static_cast<size_t>(outFile.tellp());
+        header.blockCount = numBlocks;
+        header.sections[ArchiveHeader::Blocks].offset = blocksStart;
+        header.sections[ArchiveHeader::Blocks].length = blocksEnd - blocksStart;
+        
+        // Append the block index: (offset, original size) per block
+        for (const BlockIndexEntry& entry : blockIndex)
+        {
+            record.writeU64(entry.archiveOffset);
+            record.writeU32(static_cast<uint32_t>(entry.originalSize));
+        }
+        header.sections[ArchiveHeader::BlockIndex].offset = blocksEnd;
+        header.sections[ArchiveHeader::BlockIndex].length = record.size();
+        record.flushTo(outFile);
+        
+        // Locate every file's blocks: the offset of its first block and the
+        // bytes its blocks occupy, so a single member can be found without
+        // touching the others
+        for (size_t fileIndex = 0; fileIndex < numFiles; fileIndex++)
+        {
+            FileEntry& entry = fileEntries[fileIndex];
+            size_t first = firstBlock[fileIndex];
+            size_t end = (fileIndex + 1 < numFiles) ? firstBlock[fileIndex + 1] : numBlocks;
+            entry.offsetInArchive = first < numBlocks ? blockIndex[first].archiveOffset : blocksEnd;
+            size_t endOffset = end < numBlocks ? blockIndex[end].archiveOffset : blocksEnd;
+            entry.compressedSize = (first < end) ? endOffset - entry.offsetInArchive : 0;
+        }
+        
+        // Append the serialized archive metadata: file table, file locations,
+        // statistics and creation time
+        ArchiveMetadata metadata;
+        metadata.files = fileEntries;
+        metadata.stats = stats;
+        if (lz77 != nullptr)
+        {
+            metadata.compressionMethod = Lz77::describe(*lz77);
+        }
+        else if (bwt)
+        {
+            metadata.compressionMethod = Bwt::describe();
+        }
+        
+        // List the optional block stages that were enabled after the method
+        std::vector<std::string> stages;
+        if (options.isRunLengthEnabled())
+        {
+            stages.push_back("run-length");
+        }
+        if (order1)
+        {
+            stages.push_back("order-1");
+        }
+        if (deltaStride != 0)
+        {
+            stages.push_back(deltaStride == DeltaFilter::kAutoStride ? std::string("delta auto") 
+                                                                     : "delta " + std::to_string(deltaStride));
+        }
+        std::string stageList;
+        for (const std::string& stage : stages)
+        {
+            stageList += (stageList.empty() ? "" : ", ") + stage;
+        }
+        if (!stageList.empty())
+        {
+            bool plain = lz77 == nullptr && !bwt;
+            metadata.compressionMethod += plain ? " (" + stageList + ")" : ", " + stageList;
+        }
+        metadata.timestamp = currentTimestamp();
+        std::vector<uint8_t> metadataBytes = metadata.serialize();
+        header.sections[ArchiveHeader::Metadata].offset = static_cast<size_t>(outFile.tellp());
+        header.sections[ArchiveHeader::Metadata].length = metadataBytes.size();
+        outFile.write(reinterpret_cast<const char*>(metadataBytes.data()), metadataBytes.size());
+        
+        outFile.seekp(0);
+        header.writeTo(record);
+        record.flushTo(outFile);
+        outFile.close();
+        
+        if (!outFile)
+        {
+            std::cerr << "Error: Failed to write output file " << outputFile << "\n";
+            return false;
+        }
+        
+        if (options.isVerbose())
+        {
+            std::cout << "Compression completed. Output written to: " << outputFile << "\n";
+            std::cout << "Files compressed: " << numFiles << "\n";
+            std::cout << "Blocks: " << numBlocks << " (block size " << blockSize << " bytes)\n";
+            if (sharedCodes.count() > 0)
+            {
+                std::cout << "Shared code: " << sharingFiles << " file(s), used by " 
+                          << sharedCodeBlocks << " block(s)\n";
+            }
+            if (storedBlocks > 0)
+            {
+                std::cout << "Stored blocks (incompressible): " << storedBlocks << "\n";
+            }
+            if (options.isRunLengthEnabled())
+            {
+                std::cout << "Run-length blocks: " << runLengthBlocks << "\n";
+            }
+            if (lz77 != nullptr)
+            {
+                std::cout << "Method: " << Lz77::describe(*lz77) << "\n";
+                std::cout << "LZ77 blocks: " << lz77Blocks << "\n";
+            }
+            if (bwt)
+            {
+                std::cout << "Method: " << Bwt::describe() << "\n";
+                std::cout << "BWT blocks: " << bwtBlocks << "\n";
+            }
+            if (order1)
+            {
+                std::cout << "Order-1 context blocks: " << contextBlocks << "\n";
+            }
+            if (deltaStride != 0)
+            {
+                std::cout << "Delta-filtered blocks: " << deltaBlocks << "\n";
+            }
+            std::cout << "Threads: " << options.getThreadCount() << "\n";
+            std::cout << "Maximum code length: " << maxCodeLength << " bits\n";
+            std::cout << "Original size: " << originalSize << " bytes\n";
+            std::cout << "Compressed data size: " << compressedBytes << " bytes\n";
+            std::cout << "Actual compression ratio: " << (1.0 - (double)compressedBytes / originalSize) * 100.0 << "%\n";
+            stats.printVerboseStatistics();
+        }
+        
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error during encoding: " << e.what() << "\n";
+        return false;
+    }
+}
+
+// An archive held in memory: mapped when possible, otherwise loaded
+struct LoadedArchive {
+    std::unique_ptr<MappedFile> mapping;
+    std::vector<unsigned char> loaded;
+    const unsigned char* data;
+    size_t size;
+};
+
+// Map the archive so it can be parsed in place; if it cannot be mapped,
+// load it with a single sized read instead (or read to the end when the
+// size is unknown, e.g. for a pipe)
+static void loadArchive(const std::string& inputFile, LoadedArchive& archive)
+{
+    std::ifstream file(inputFile, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw HuffmanException::fileError(inputFile, "open");
+    }
+    
+    archive.mapping.reset(new MappedFile(inputFile));
+    archive.data = archive.mapping->data();
+    archive.size = archive.mapping->size();
+    if (!archive.mapping->isMapped())
+    {
+        std::streamoff length = file.seekg(0, std::ios::end).tellg();
+        bool sized = length > 0 && file.seekg(0, std::ios::beg);
+        if (!sized)
+        {
+            file.clear();
+        }
+        
+        // Check the header before allocating room for the rest of the archive
+        unsigned char headerBytes[ArchiveHeader::kSize];
+        if (!file.read(reinterpret_cast<char*>(headerBytes), sizeof(headerBytes)))
+        {
+            throw HuffmanException::archiveFormatError("Not a Huffman archive (file too short)");
+        }
+        ArchiveReader headerReader(headerBytes, sizeof(headerBytes));
+        ArchiveHeader::parse(headerReader, sized ? static_cast<uint64_t>(length) : UINT64_MAX);
+        
+        archive.loaded.assign(headerBytes, headerBytes + sizeof(headerBytes));
+        if (sized)
+        {
+            archive.loaded.resize(static_cast<size_t>(length));
+            if (!file.read(reinterpret_cast<char*>(archive.loaded.data()) + sizeof(headerBytes), 
+                           length - sizeof(headerBytes)))
+            {
+                throw HuffmanException::fileError(inputFile, "read");
+            }
+        }
+        else
+        {
+            archive.loaded.insert(archive.loaded.end(), std::istreambuf_iterator<char>(file), 
+                                  std::istreambuf_iterator<char>());
+        }
+        archive.data = archive.loaded.data();
+        archive.size = archive.loaded.size();
+    }
+}
+
+// One self-contained archive; an archive file is a sequence of these
+struct ArchiveMember {
+    ArchiveHeader header;
+    ArchiveMetadata metadata;
+    SharedCodeTables codeTables;
+    size_t offset;                    // start of the member in the archive file
+    size_t blocksEnd;                 // end of its blocks section in the archive file
+};
+
+// Everything the headers, block indexes and metadata say about an archive
+struct ArchiveLayout {
+    std::vector<ArchiveMember> members;
+    std::vector<FileEntry> files;     // files of all members in order; offsets are absolute
+    std::vector<size_t> outputFile;   // first piece of the output file each entry belongs to
+    std::vector<size_t> fileMember;   // member holding each file
+    std::vector<BlockIndexEntry> blockIndex;
+    std::vector<size_t> firstBlock;   // first block of each file; one extra entry marks the end
+    uint64_t originalSize;
+};
+
+// Parse and validate one member starting at base, appending its files and
+// blocks to layout. Offsets inside a member are relative to its start.
+// Returns the end of the member.
+static size_t readArchiveMember(const unsigned char* data, size_t size, size_t base, ArchiveLayout& layout)
+{
+    ArchiveReader reader(data + base, size - base);
+    ArchiveMember member;
+    member.offset = base;
+    member.header = ArchiveHeader::parse(reader, size - base);
+    const ArchiveHeader& header = member.header;
+    if (header.blockSize == 0 || header.blockSize > CommandLineOptions::kMaxBlockSize)
+    {
+        throw HuffmanException::archiveFormatError("Corrupted archive header");
+    }
+    
+    // Read the metadata: names, sizes and locations of the files
+    const ArchiveSection& metadataSection = header.sections[ArchiveHeader::Metadata];
+    reader.seek(static_cast<size_t>(metadataSection.offset));
+    const unsigned char* metadataBytes = reader.readBytes(static_cast<size_t>(metadataSection.length));
+    member.metadata = ArchiveMetadata::deserialize(
+        std::vector<uint8_t>(metadataBytes, metadataBytes + metadataSection.length));
+    size_t memberEnd = reader.position();
+    
+    const ArchiveSection& codeSection = header.sections[ArchiveHeader::CodeTables];
+    reader.seek(static_cast<size_t>(codeSection.offset));
+    member.codeTables = SharedCodeTables::parse(reader, static_cast<size_t>(codeSection.length));
+    
+    const std::vector<FileEntry>& files = member.metadata.files;
+    uint64_t filesTotal = 0;
+    for (const FileEntry& entry : files)
+    {
+        filesTotal += entry.originalSize;
+    }
+    if (files.size() != header.fileCount || filesTotal != header.originalSize)
+    {
+        throw HuffmanException::archiveFormatError("Archive metadata does not match header");
+    }
+    
+    // Read the block index and check it covers every file exactly once,
+    // with each file starting a new block inside the blocks section
+    const ArchiveSection& blocks = header.sections[ArchiveHeader::Blocks];
+    const ArchiveSection& indexSection = header.sections[ArchiveHeader::BlockIndex];
+    const size_t kIndexEntrySize = 12;
+    if (indexSection.length % kIndexEntrySize != 0 || indexSection.length / kIndexEntrySize != header.blockCount)
+    {
+        throw HuffmanException::archiveFormatError("Corrupted block index");
+    }
+    size_t blocksEnd = static_cast<size_t>(blocks.offset + blocks.length);
+    reader.seek(static_cast<size_t>(indexSection.offset));
+    
+    size_t numBlocks = static_cast<size_t>(header.blockCount);
+    size_t firstFile = layout.files.size();
+    size_t blockNumber = layout.blockIndex.size();
+    layout.blockIndex.resize(blockNumber + numBlocks);
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        layout.firstBlock.push_back(blockNumber);
+        size_t fileSize = files[i].originalSize;
+        for (size_t outputOffset = 0; outputOffset < fileSize; blockNumber++)
+        {
+            if (blockNumber >= layout.blockIndex.size())
+            {
+                throw HuffmanException::archiveFormatError("Corrupted block index");
+            }
+            BlockIndexEntry& entry = layout.blockIndex[blockNumber];
+            entry.archiveOffset = reader.readSize();
+            entry.originalSize = reader.readU32();
+            if (entry.originalSize != std::min<size_t>(header.blockSize, fileSize - outputOffset) ||
+                entry.archiveOffset < blocks.offset || entry.archiveOffset >= blocksEnd)
+            {
+                throw HuffmanException::archiveFormatError("Corrupted block index");
+            }
+            entry.fileIndex = firstFile + i;
+            entry.outputOffset = outputOffset;
+            entry.archiveOffset += base;
+            outputOffset += entry.originalSize;
+        }
+    }
+    if (blockNumber != layout.blockIndex.size())
+    {
+        throw HuffmanException::archiveFormatError("Corrupted block index");
+    }
+    
+    // Check each file's recorded location agrees with the block index
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        FileEntry entry = files[i];
+        size_t first = layout.firstBlock[firstFile + i];
+        size_t end = i + 1 < files.size() ? layout.firstBlock[firstFile + i + 1] : blockNumber;
+        if (first < end && 
+            (entry.offsetInArchive != layout.blockIndex[first].archiveOffset - base ||
+             entry.compressedSize > blocksEnd - entry.offsetInArchive))
+        {
+            throw HuffmanException::archiveFormatError("Corrupted file index");
+        }
+        entry.offsetInArchive += base;
+        layout.files.push_back(entry);
+        layout.fileMember.push_back(layout.members.size());
+    }
+    
+    layout.originalSize += header.originalSize;
+    member.blocksEnd = base + blocksEnd;
+    layout.members.push_back(member);
+    return base + memberEnd;
+}
+
+// Parse and validate every member of an archive in memory. A file split
+// across members by --shard is restored as one file: the first file of a
+// member joins the last file of the previous one when its piece offset says
+// it continues exactly where that piece ends (same path, offset equal to the
+// previous piece's offset plus size). Each entry's block output offsets are
+// made relative to the joined file.
+static void readArchiveLayout(const unsigned char* data, size_t size, ArchiveLayout& layout)
+{
+    layout.originalSize = 0;
+    size_t position = 0;
+    do
+    {
+        position = readArchiveMember(data, size, position, layout);
+    } while (position < size);
+    layout.firstBlock.push_back(layout.blockIndex.size());
+    
+    std::vector<uint64_t> pieceOffsets(layout.files.size(), 0);
+    size_t nextMemberFile = 0;
+    for (const ArchiveMember& member : layout.members)
+    {
+        size_t first = nextMemberFile;
+        nextMemberFile += member.metadata.files.size();
+        for (size_t i = first; i < nextMemberFile; i++)
+        {
+            layout.outputFile.push_back(i);
+        }
+        if (first > 0 && first < nextMemberFile && layout.files[first].pieceOffset != 0 &&
+            layout.files[first].pieceOffset == 
+                layout.files[first - 1].pieceOffset + layout.files[first - 1].originalSize &&
+            layout.files[first].relativePath == layout.files[first - 1].relativePath &&
+            layout.files[first].filename == layout.files[first - 1].filename)
+        {
+            layout.outputFile[first] = layout.outputFile[first - 1];
+            pieceOffsets[first] = pieceOffsets[first - 1] + layout.files[first - 1].originalSize;
+        }
+    }
+    for (BlockIndexEntry& entry : layout.blockIndex)
+    {
+        entry.outputOffset += pieceOffsets[entry.fileIndex];
+    }
+}
+
+// Indices of every file in an archive
+static std::vector<size_t> allFileIndices(const ArchiveLayout& layout)
+{
+    std::vector<size_t> indices(layout.files.size());
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+        indices[i] = i;
+    }
+    return indices;
+}
+
+// Receives every decoded block: its index entry and its decoded bytes
+typedef std::function<void(const BlockIndexEntry&, const unsigned char*, size_t)> BlockSink;
+
+// Decode the blocks of the selected files on the thread pool straight from
+// the archive buffer and check every block's and every file's CRC-32C.
+// Decoded blocks go to sink, if one is given; blocks of other files are
+// never touched.
+static void decodeFiles(const LoadedArchive& archive, const ArchiveLayout& layout,
+                        const std::vector<size_t>& selected, size_t threadCount,
+                        const BlockSink& sink)
+{
+    const std::vector<FileEntry>& files = layout.files;
+    std::vector<uint32_t> blockChecksums(layout.blockIndex.size());
+    
+    auto decodeBlockTask = [&](size_t blockNumber)
+    {
+        const BlockIndexEntry& entry = layout.blockIndex[blockNumber];
+        const ArchiveMember& member = layout.members[layout.fileMember[entry.fileIndex]];
+        ArchiveReader reader(archive.data, member.blocksEnd);
+        reader.seek(entry.archiveOffset);
+        ArchiveBlock block = ArchiveBlock::parse(reader, entry.originalSize, member.codeTables);
+        if (block.originalSize != entry.originalSize)
+        {
+            throw HuffmanException::archiveFormatError("Block size does not match block index");
+        }
+        
+        // Stored blocks are checked and handed on straight from the archive
+        // buffer; coded blocks are decoded into a buffer of their own
+        std::vector<unsigned char> decoded;
+        const unsigned char* data = block.payloadData();
+        if (block.mode != ArchiveBlock::Stored)
+        {
+            decoded.resize(block.originalSize);
+            HuffmanAlgorithm::decompressBlock(block, decoded.data());
+            data = decoded.data();
+        }
+        
+        uint32_t checksum = Crc32c::compute(data, block.originalSize);
+        if (checksum != block.checksum)
+        {
+            throw HuffmanException::archiveFormatError("Checksum mismatch in block " + 
+                std::to_string(blockNumber - layout.firstBlock[entry.fileIndex]) + 
+                " of " + files[entry.fileIndex].filename);
+        }
+        blockChecksums[blockNumber] = checksum;
+        
+        if (sink)
+        {
+            sink(entry, data, block.originalSize);
+        }
+        archive.mapping->release(entry.archiveOffset, reader.position() - entry.archiveOffset);
+    };
+    
+    ThreadPool pool(threadCount);
+    std::vector<std::future<void>> pending;
+    for (size_t fileIndex : selected)
+    {
+        for (size_t i = layout.firstBlock[fileIndex]; i < layout.firstBlock[fileIndex + 1]; i++)
+        {
+            pending.push_back(pool.submit([&decodeBlockTask, i]() { decodeBlockTask(i); }));
+        }
+    }
+    for (std::future<void>& done : pending)
+    {
+        done.get();
+    }
+    
+    // The block checksums, combined in order, must give each file's checksum;
+    // this also catches blocks that are missing or out of order
+    for (size_t fileIndex : selected)
+    {
+        uint32_t checksum = 0;
+        for (size_t i = layout.firstBlock[fileIndex]; i < layout.firstBlock[fileIndex + 1]; i++)
+        {
+            checksum = Crc32c::combine(checksum, blockChecksums[i], layout.blockIndex[i].originalSize);
+        }
+        if (checksum != files[fileIndex].checksum)
+        {
+            throw HuffmanException::archiveFormatError("Checksum mismatch in file " + files[fileIndex].filename);
+        }
+    }
+}
+
+// One restored file: opened once, created at its final size, and written
+// by the decode tasks under its lock
+struct RestoredFile {
+    std::string path;
+    uint64_t size;
+    std::fstream stream;
+    std::mutex lock;
+};
+
+// Decode the selected files of an archive into outputDir
+static void restoreFiles(const LoadedArchive& archive, const ArchiveLayout& layout,
+                         const std::vector<size_t>& selected, const std::string& outputDir,
+                         size_t threadCount, bool verbose)
+{
+    // Create output directory if it doesn't exist
+    // Note: This is a simplified approach. In a full implementation, 
+    // you'd use proper cross-platform directory creation
+    std::string createDirCmd = "mkdir \"" + outputDir + "\" 2>nul"; // Windows
+    system(createDirCmd.c_str());
+    
+    if (verbose)
+    {
+        std::cout << "Decompressing files to directory: " << outputDir << "\n";
+    }
+    
+    // The pieces of a split file all go to the output of its first piece.
+    // Outputs are keyed by path: when entries share a name, the last one
+    // wins, as it always has, and the blocks of the others are decoded and
+    // checked but not written
+    std::vector<uint64_t> outputSizes(layout.files.size(), 0);
+    std::vector<size_t> outputs;
+    std::map<std::string, size_t> ownerOfPath;
+    for (size_t fileIndex : selected)
+    {
+        size_t output = layout.outputFile[fileIndex];
+        if (std::find(outputs.begin(), outputs.end(), output) == outputs.end())
+        {
+            outputs.push_back(output);
+        }
+        outputSizes[output] += layout.files[fileIndex].originalSize;
+    }
+    for (size_t output : outputs)
+    {
+        ownerOfPath[outputDir + "/" + layout.files[output].filename] = output;
+    }
+    
+    // Create every output file at its final size so blocks can be written
+    // into their own regions in any order
+    std::vector<std::unique_ptr<RestoredFile>> restored;
+    std::vector<RestoredFile*> restoredOf(layout.files.size(), nullptr);
+    for (size_t output : outputs)
+    {
+        std::string fullPath = outputDir + "/" + layout.files[output].filename;
+        if (ownerOfPath[fullPath] != output)
+        {
+            if (verbose)
+            {
+                std::cout << "Skipping entry " << layout.files[output].relativePath 
+                          << ": a later entry is also restored to " << fullPath << "\n";
+            }
+            continue;
+        }
+        
+        restored.push_back(std::unique_ptr<RestoredFile>(new RestoredFile()));
+        RestoredFile& file = *restored.back();
+        file.path = fullPath;
+        file.size = outputSizes[output];
+        file.stream.open(fullPath, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+        if (!file.stream.is_open())
+        {
+            throw HuffmanException::fileError(fullPath, "create (make sure '" + outputDir + 
+                                              "' exists and is writable)");
+        }
+        if (file.size > 0)
+        {
+            file.stream.seekp(file.size - 1);
+            file.stream.put('\0');
+        }
+        restoredOf[output] = &file;
+    }
+    
+    decodeFiles(archive, layout, selected, threadCount, 
+                [&restoredOf, &layout](const BlockIndexEntry& entry, const unsigned char* data, size_t size)
+    {
+        RestoredFile* file = restoredOf[layout.outputFile[entry.fileIndex]];
+        if (file == nullptr)
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> guard(file->lock);
+        file->stream.seekp(entry.outputOffset);
+        if (!file->stream.write(reinterpret_cast<const char*>(data), size))
+        {
+            throw HuffmanException::fileError(file->path, "write");
+        }
+    });
+    
+    for (const std::unique_ptr<RestoredFile>& file : restored)
+    {
+        file->stream.close();
+        if (file->stream.fail())
+        {
+            throw HuffmanException::fileError(file->path, "write");
+        }
+        if (verbose)
+        {
+            std::cout << "Restored file: " << file->path << " (" << file->size << " bytes)\n";
+        }
+    }
+}
+
+bool HuffmanAlgorithm::decodeArchive(const CommandLineOptions& options)
+{
+    try 
+    {
+        if (options.isVerbose()) 
+        {
+            std::cout << "Decoding archive: " << options.getInputFiles()[0] << "\n";
+        }
+        
+        LoadedArchive archive;
+        loadArchive(options.getInputFiles()[0], archive);
+        ArchiveLayout layout;
+        readArchiveLayout(archive.data, archive.size, layout);
+        
+        if (options.isVerbose())
+        {
+            std::cout << "Original total size: " << layout.originalSize << " bytes\n";
+            std::cout << "Number of files: " << layout.files.size() << "\n";
+            std::cout << "Members: " << layout.members.size() << "\n";
+            std::cout << "Blocks: " << layout.blockIndex.size() << "\n";
+            std::cout << "Threads: " << options.getThreadCount() << "\n";
+            
+            // Per-block code tables are not shown; display each member's summary
+            for (size_t i = 0; i < layout.members.size(); i++)
+            {
+                const ArchiveMember& member = layout.members[i];
+                const CompressionStatistics& storedStats = member.metadata.stats;
+                std::cout << "\nMember " << (i + 1) << " at offset " << member.offset << ": " 
+                          << member.header.blockCount << " blocks (block size " << member.header.blockSize << " bytes)\n";
+                std::cout << "Compressed data: " << storedStats.totalCompressedSize << " bytes\n";
+                storedStats.printVerboseStatistics();
+            }
+        }
+        
+        // If output directory is specified, restore files to that directory
+        std::string outputDir = options.getOutputFile();
+        if (outputDir.empty())
+        {
+            outputDir = "decompressed"; // Default directory
+        }
+        
+        restoreFiles(archive, layout, allFileIndices(layout), outputDir, 
+                     options.getThreadCount(), options.isVerbose());
+        
+        if (options.isVerbose())
+        {
+            std::cout << "Decoding completed successfully!\n";
+            std::cout << "Size verification: " << layout.originalSize << " bytes\n";
+        }
+        
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error during decoding: " << e.what() << "\n";
+        return false;
+    }
+}
+
+bool HuffmanAlgorithm::extractFiles(const CommandLineOptions& options)
+{
+    try 
+    {
+        const std::vector<std::string>& arguments = options.getInputFiles();
+        if (options.isVerbose()) 
+        {
+            std::cout << "Extracting from archive: " << arguments[0] << "\n";
+        }
+        
+        LoadedArchive archive;
+        loadArchive(arguments[0], archive);
+        ArchiveLayout layout;
+        readArchiveLayout(archive.data, archive.size, layout);
+        
+        // Look up every requested member by name in the file index
+        std::vector<size_t> selected;
+        for (size_t i = 1; i < arguments.size(); i++)
+        {
+            bool found = false;
+            for (size_t fileIndex = 0; fileIndex < layout.files.size(); fileIndex++)
+            {
+                if (layout.files[fileIndex].filename == arguments[i] &&
+                    std::find(selected.begin(), selected.end(), fileIndex) == selected.end())
+                {
+                    selected.push_back(fileIndex);
+                    found = true;
+                }
+            }
+            if (!found)
+            {
+                std::cerr << "Error: File not found in archive: " << arguments[i] << "\n";
+                return false;
+            }
+        }
+        
+        if (options.isVerbose())
+        {
+            for (size_t fileIndex : selected)
+            {
+                const FileEntry& entry = layout.files[fileIndex];
+                std::cout << "Entry " << entry.filename << ": offset " << entry.offsetInArchive
+                          << ", " << entry.compressedSize << " compressed bytes, "
+                          << (layout.firstBlock[fileIndex + 1] - layout.firstBlock[fileIndex]) << " blocks\n";
+            }
+        }
+        
+        std::string outputDir = options.getOutputFile();
+        if (outputDir.empty())
+        {
+            outputDir = "decompressed"; // Default directory
+        }
+        restoreFiles(archive, layout, selected, outputDir, options.getThreadCount(), options.isVerbose());
+        
+        if (options.isVerbose())
+        {
+            std::cout << "Extraction completed successfully!\n";
+        }
+        
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error during extraction: " << e.what() << "\n";
+        return false;
+    }
+}
+
+bool HuffmanAlgorithm::testArchive(const CommandLineOptions& options)
+{
+    try 
+    {
+        std::string inputFile = options.getInputFiles()[0];
+        if (options.isVerbose()) 
+        {
+            std::cout << "Testing archive: " << inputFile << "\n";
+            std::cout << "CRC-32C: " << (Crc32c::isHardwareAccelerated() ? "SSE4.2" : "portable") << "\n";
+            std::cout << "Threads: " << options.getThreadCount() << "\n";
+        }
+        
+        // Decode everything and check all checksums, discarding the output
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        LoadedArchive archive;
+        loadArchive(inputFile, archive);
+        ArchiveLayout layout;
+        readArchiveLayout(archive.data, archive.size, layout);
+        decodeFiles(archive, layout, allFileIndices(layout), options.getThreadCount(), BlockSink());
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        
+        if (options.isVerbose())
+        {
+            for (const FileEntry& entry : layout.files)
+            {
+                std::ostringstream checksum;
+                checksum << std::hex << std::setw(8) << std::setfill('0') << entry.checksum;
+                std::cout << "OK: " << entry.filename << " (" << entry.originalSize 
+                          << " bytes, CRC-32C " << checksum.str() << ")\n";
+            }
+        }
+        
+        // Pieces of a split file count as one file
+        size_t fileCount = 0;
+        for (size_t i = 0; i < layout.files.size(); i++)
+        {
+            fileCount += layout.outputFile[i] == i;
+        }
+        double megabytes = layout.originalSize / 1e6;
+        std::cout << "Archive OK: " << fileCount << " file(s), " 
+                  << layout.originalSize << " bytes in " << layout.blockIndex.size() << " blocks verified";
+        if (layout.members.size() > 1)
+        {
+            std::cout << " (" << layout.members.size() << " members)";
+        }
+        std::cout << "\n";
+        std::ostringstream timing;
+        timing << std::fixed << std::setprecision(3) << seconds << " s, "
+               << std::setprecision(1) << (seconds > 0 ? megabytes / seconds : 0.0) << " MB/s";
+        std::cout << "Time: " << timing.str() << "\n";
+        
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error during archive test: " << e.what() << "\n";
+        return false;
     }
 }
 
@@ -616,7 +1842,6 @@ bool HuffmanAlgorithm::displayArchiveInfo(const CommandLineOptions& options)
             std::cout << "Archive information for: " << options.getInputFiles()[0] << "\n";
         }
         
-        // Read archive file to get basic information
         std::string inputFile = options.getInputFiles()[0];
         std::ifstream file(inputFile, std::ios::binary);
         if (!file.is_open())
@@ -625,18 +1850,42 @@ bool HuffmanAlgorithm::displayArchiveInfo(const CommandLineOptions& options)
             return false;
         }
         
-        // Get file size
+        // Only the fixed header and the metadata section of each member are
+        // read; blocks and block indexes stay untouched
         file.seekg(0, std::ios::end);
-        size_t fileSize = file.tellg();
-        file.close();
-        
+        size_t fileSize = static_cast<size_t>(file.tellg());
         std::cout << "Archive file: " << inputFile << "\n";
         std::cout << "Archive size: " << fileSize << " bytes\n";
         
-        if (options.isVerbose())
+        size_t memberStart = 0;
+        for (size_t memberNumber = 1; memberStart < fileSize || memberNumber == 1; memberNumber++)
         {
-            std::cout << "Note: Complete archive metadata reading would require\n";
-            std::cout << "implementation of archive format with stored metadata.\n";
+            unsigned char headerBytes[ArchiveHeader::kSize];
+            if (!file.seekg(static_cast<std::streamoff>(memberStart), std::ios::beg) || 
+                !file.read(reinterpret_cast<char*>(headerBytes), sizeof(headerBytes)))
+            {
+                throw HuffmanException::archiveFormatError("Not a Huffman archive (file too short)");
+            }
+            ArchiveReader headerReader(headerBytes, sizeof(headerBytes));
+            ArchiveHeader header = ArchiveHeader::parse(headerReader, fileSize - memberStart);
+            
+            const ArchiveSection& metadataSection = header.sections[ArchiveHeader::Metadata];
+            std::vector<uint8_t> metadataBytes(static_cast<size_t>(metadataSection.length));
+            file.seekg(static_cast<std::streamoff>(memberStart + metadataSection.offset));
+            if (!file.read(reinterpret_cast<char*>(metadataBytes.data()), metadataBytes.size()))
+            {
+                throw HuffmanException::fileError(inputFile, "read");
+            }
+            ArchiveMetadata metadata = ArchiveMetadata::deserialize(metadataBytes);
+            
+            size_t memberEnd = memberStart + static_cast<size_t>(metadataSection.offset + metadataSection.length);
+            if (memberNumber > 1 || memberEnd < fileSize)
+            {
+                std::cout << "\nMember " << memberNumber << " (offset " << memberStart << ", " 
+                          << (memberEnd - memberStart) << " bytes):\n";
+            }
+            metadata.printArchiveInfo(options.isVerbose());
+            memberStart = memberEnd;
         }
         
         return true;
@@ -647,3 +1896,66 @@ bool HuffmanAlgorithm::displayArchiveInfo(const CommandLineOptions& options)
         return false;
     }
 }
+
+bool HuffmanAlgorithm::countFrequencies(const CommandLineOptions& options)
+{
+    try 
+    {
+        // Saved tables are merged as they are; other inputs are counted,
+        // restricted to this shard when --shard is given
+        FrequencyTable table;
+        std::vector<std::string> dataFiles;
+        size_t mergedTables = 0;
+        for (const std::string& path : options.getInputFiles())
+        {
+            if (FrequencyTable::isTableFile(path))
+            {
+                if (options.isVerbose())
+                {
+                    std::cout << "Merging table: " << path << "\n";
+                }
+                table.merge(FrequencyTable::load(path));
+                mergedTables++;
+            }
+            else
+            {
+                dataFiles.push_back(path);
+            }
+        }
+        
+        std::vector<FileEntry> fileEntries;
+        std::vector<size_t> rangeStarts;
+        collectInputs(options, dataFiles, fileEntries, rangeStarts);
+        for (size_t i = 0; i < fileEntries.size(); i++)
+        {
+            const std::string& path = fileEntries[i].relativePath;
+            size_t rangeStart = rangeStarts[i];
+            size_t rangeSize = fileEntries[i].originalSize;
+            
+            uint64_t counts[256] = {0};
+            countFileRange(path, rangeStart, rangeSize, counts);
+            table.add(counts);
+        }
+        
+        table.save(options.getOutputFile());
+        
+        if (options.isVerbose())
+        {
+            size_t distinct = 0;
+            for (int symbol = 0; symbol < 256; symbol++)
+            {
+                distinct += table.count(static_cast<unsigned char>(symbol)) != 0;
+            }
+            std::cout << "Counted " << fileEntries.size() << " file(s), merged " << mergedTables << " table(s)\n";
+            std::cout << "Total bytes: " << table.total() << ", distinct symbols: " << distinct << "\n";
+            std::cout << "Frequency table written to: " << options.getOutputFile() << "\n";
+        }
+        
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error while counting frequencies: " << e.what() << "\n";
+        return false;
+    }
+}
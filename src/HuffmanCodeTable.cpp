@@ -0,0 +1,280 @@
+#include "../include/HuffmanCodeTable.h"
+#include "../include/HuffmanException.h"
+#include <algorithm>
+#include <vector>
+
+HuffmanCodeTable::HuffmanCodeTable()
+{
+    for (int i = 0; i < 256; i++)
+    {
+        codes[i] = 0;
+        lengths[i] = 0;
+    }
+}
+
+HuffmanCodeTable HuffmanCodeTable::fromCodeStrings(const std::map<char, std::string>& codes)
+{
+    HuffmanCodeTable table;
+    for (const auto& pair : codes)
+    {
+        unsigned char symbol = static_cast<unsigned char>(pair.first);
+        uint64_t value = 0;
+        for (char bit : pair.second)
+        {
+            value = (value << 1) | (bit == '1' ? 1u : 0u);
+        }
+        table.codes[symbol] = value;
+        table.lengths[symbol] = static_cast<uint8_t>(pair.second.length());
+    }
+    return table;
+}
+
+HuffmanCodeTable HuffmanCodeTable::fromCodeLengths(const uint8_t lengths[256])
+{
+    // Count codes of each length
+    unsigned lengthCounts[kMaxCodeLength + 1] = {0};
+    for (int symbol = 0; symbol < 256; symbol++)
+    {
+        if (lengths[symbol] > kMaxCodeLength)
+        {
+            throw HuffmanException::archiveFormatError("Code length exceeds maximum");
+        }
+        lengthCounts[lengths[symbol]]++;
+    }
+    lengthCounts[0] = 0;
+
+    // First canonical code of each length; reject over-subscribed code spaces
+    uint64_t nextCode[kMaxCodeLength + 2] = {0};
+    uint64_t code = 0;
+    for (unsigned length = 1; length <= kMaxCodeLength; length++)
+    {
+        code = (code + lengthCounts[length - 1]) << 1;
+        nextCode[length] = code;
+        if (code + lengthCounts[length] > (static_cast<uint64_t>(1) << length))
+        {
+            throw HuffmanException::archiveFormatError("Code lengths do not form a prefix code");
+        }
+    }
+
+    // Symbols of equal length receive consecutive codes in byte order
+    HuffmanCodeTable table;
+    for (int symbol = 0; symbol < 256; symbol++)
+    {
+        if (lengths[symbol] != 0)
+        {
+            table.lengths[symbol] = lengths[symbol];
+            table.codes[symbol] = nextCode[lengths[symbol]]++;
+        }
+    }
+    return table;
+}
+
+HuffmanCodeTable HuffmanCodeTable::fromFrequencies(const uint64_t frequencies[256], unsigned maxLength)
+{
+    uint8_t lengths[256];
+    computeCodeLengths(frequencies, lengths);
+    limitCodeLengths(lengths, frequencies, maxLength);
+    return fromCodeLengths(lengths);
+}
+
+void HuffmanCodeTable::computeCodeLengths(const uint64_t frequencies[256], uint8_t lengths[256])
+{
+    // Used symbols sorted by ascending count (ties by byte value)
+    int symbols[256];
+    int n = 0;
+    for (int symbol = 0; symbol < 256; symbol++)
+    {
+        lengths[symbol] = 0;
+        if (frequencies[symbol] != 0)
+            symbols[n++] = symbol;
+    }
+    if (n == 0)
+        return;
+    if (n == 1)
+    {
+        lengths[symbols[0]] = 1;
+        return;
+    }
+    std::sort(symbols, symbols + n, [&](int a, int b) {
+        return frequencies[a] < frequencies[b] || (frequencies[a] == frequencies[b] && a < b);
+    });
+
+    uint64_t a[256];
+    for (int i = 0; i < n; i++)
+    {
+        a[i] = frequencies[symbols[i]];
+    }
+
+    // First pass, left to right: a[] turns into internal node weights, and
+    // nodes already merged into a parent store the parent's index instead
+    a[0] += a[1];
+    int root = 0;
+    int leaf = 2;
+    for (int next = 1; next < n - 1; next++)
+    {
+        if (leaf >= n || a[root] < a[leaf])
+        {
+            a[next] = a[root];
+            a[root++] = next;
+        }
+        else
+        {
+            a[next] = a[leaf++];
+        }
+
+        if (leaf >= n || (root < next && a[root] < a[leaf]))
+        {
+            a[next] += a[root];
+            a[root++] = next;
+        }
+        else
+        {
+            a[next] += a[leaf++];
+        }
+    }
+
+    // Second pass, right to left: parent indices become internal node depths
+    a[n - 2] = 0;
+    for (int next = n - 3; next >= 0; next--)
+    {
+        a[next] = a[a[next]] + 1;
+    }
+
+    // Third pass, right to left: count the free slots per depth and hand
+    // them to the leaves, most frequent symbols first
+    int available = 1;
+    int used = 0;
+    unsigned depth = 0;
+    root = n - 2;
+    int next = n - 1;
+    while (available > 0)
+    {
+        while (root >= 0 && a[root] == depth)
+        {
+            used++;
+            root--;
+        }
+        while (available > used)
+        {
+            a[next--] = depth;
+            available--;
+        }
+        available = 2 * used;
+        depth++;
+        used = 0;
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        lengths[symbols[i]] = static_cast<uint8_t>(a[i]);
+    }
+}
+
+void HuffmanCodeTable::limitCodeLengths(uint8_t lengths[256], const uint64_t frequencies[256], 
+                                        unsigned maxLength)
+{
+    // Symbols in use, least frequent first (ties by byte value)
+    int symbols[256];
+    int symbolCount = 0;
+    bool fits = true;
+    for (int symbol = 0; symbol < 256; symbol++)
+    {
+        if (lengths[symbol] != 0)
+        {
+            symbols[symbolCount++] = symbol;
+            fits = fits && lengths[symbol] <= maxLength;
+        }
+    }
+    if (fits)
+        return;
+    if (maxLength < 1 || (maxLength < 8 && symbolCount > (1 << maxLength)))
+    {
+        throw HuffmanException::compressionError("Too many symbols for the maximum code length");
+    }
+    std::stable_sort(symbols, symbols + symbolCount, [&](int a, int b) {
+        return frequencies[a] < frequencies[b];
+    });
+
+    // Package-merge: the list for depth d merges the sorted symbols with
+    // pairs ("packages") of the list for depth d + 1. Only whether each item
+    // is a package is kept per depth; that is enough to read lengths back.
+    const int kMaxItems = 2 * 256;
+    std::vector<uint8_t> isPackage(static_cast<size_t>(maxLength + 1) * kMaxItems, 0);
+    std::vector<size_t> itemCount(maxLength + 1, 0);
+    uint64_t previous[kMaxItems];
+    uint64_t current[kMaxItems];
+    size_t previousCount = 0;
+
+    for (unsigned depth = maxLength; depth >= 1; depth--)
+    {
+        size_t packageCount = previousCount / 2;
+        size_t leaf = 0;
+        size_t package = 0;
+        size_t count = 0;
+        uint8_t* flags = &isPackage[depth * kMaxItems];
+        while (leaf < static_cast<size_t>(symbolCount) || package < packageCount)
+        {
+            uint64_t leafWeight = leaf < static_cast<size_t>(symbolCount) ? frequencies[symbols[leaf]] : 0;
+            uint64_t packageWeight = package < packageCount 
+                                     ? previous[2 * package] + previous[2 * package + 1] : 0;
+            if (package >= packageCount || 
+                (leaf < static_cast<size_t>(symbolCount) && leafWeight <= packageWeight))
+            {
+                current[count] = leafWeight;
+                flags[count++] = 0;
+                leaf++;
+            }
+            else
+            {
+                current[count] = packageWeight;
+                flags[count++] = 1;
+                package++;
+            }
+        }
+        itemCount[depth] = count;
+        std::copy(current, current + count, previous);
+        previousCount = count;
+    }
+
+    // The cheapest 2n - 2 items at depth 1 form the optimal code. Every leaf
+    // among the selected items of a depth adds one bit to its symbol, and
+    // each selected package selects two items of the next depth.
+    for (int i = 0; i < symbolCount; i++)
+    {
+        lengths[symbols[i]] = 0;
+    }
+    size_t selected = symbolCount > 1 ? 2 * static_cast<size_t>(symbolCount) - 2 : 1;
+    for (unsigned depth = 1; depth <= maxLength && selected > 0; depth++)
+    {
+        const uint8_t* flags = &isPackage[depth * kMaxItems];
+        size_t leaves = 0;
+        size_t packages = 0;
+        for (size_t i = 0; i < selected && i < itemCount[depth]; i++)
+        {
+            if (flags[i])
+                packages++;
+            else
+                lengths[symbols[leaves++]]++;
+        }
+        selected = 2 * packages;
+    }
+}
+
+std::map<char, std::string> HuffmanCodeTable::toCodeStrings() const
+{
+    std::map<char, std::string> result;
+    for (int symbol = 0; symbol < 256; symbol++)
+    {
+        if (lengths[symbol] == 0)
+            continue;
+
+        std::string code(lengths[symbol], '0');
+        for (unsigned bit = 0; bit < lengths[symbol]; bit++)
+        {
+            if ((codes[symbol] >> (lengths[symbol] - 1 - bit)) & 1)
+                code[bit] = '1';
+        }
+        result[static_cast<char>(symbol)] = code;
+    }
+    return result;
+}
@@ -0,0 +1,221 @@
+#include "../include/HuffmanDecoder.h"
+#include "../include/HuffmanException.h"
+#include "../include/BitStream.h"
+#include "../include/ContextModel.h"
+
+HuffmanDecoder::HuffmanDecoder(const HuffmanCodeTable& table, unsigned minTableBits)
+    : tableBits(0)
+{
+    for (unsigned symbol = 0; symbol < 256; symbol++)
+    {
+        if (table.lengths[symbol] > HuffmanCodeTable::kMaxCodeLength)
+        {
+            throw HuffmanException::archiveFormatError("Huffman code longer than the decoder supports");
+        }
+        if (table.lengths[symbol] > tableBits)
+            tableBits = table.lengths[symbol];
+    }
+    if (tableBits == 0)
+        return;   // no symbols: any attempt to decode is an error
+    if (minTableBits > tableBits && minTableBits <= HuffmanCodeTable::kMaxCodeLength)
+        tableBits = minTableBits;
+
+    entries.assign(static_cast<size_t>(1) << tableBits, 0);
+    for (unsigned symbol = 0; symbol < 256; symbol++)
+    {
+        unsigned length = table.lengths[symbol];
+        if (length == 0)
+            continue;
+
+        // Replicate the entry over every index sharing the code as prefix
+        size_t first = static_cast<size_t>(table.codes[symbol]) << (tableBits - length);
+        size_t count = static_cast<size_t>(1) << (tableBits - length);
+        if (first + count > entries.size())
+        {
+            throw HuffmanException::archiveFormatError("Huffman codes are not prefix-free");
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            uint16_t& entry = entries[first + i];
+            if (entry != 0)
+            {
+                throw HuffmanException::archiveFormatError("Huffman codes are not prefix-free");
+            }
+            entry = static_cast<uint16_t>((length << 8) | symbol);
+        }
+    }
+}
+
+size_t HuffmanDecoder::decode(const unsigned char* data, size_t size, size_t totalBits,
+                              unsigned char* out, size_t count) const
+{
+    if (count > 0 && entries.empty())
+    {
+        throw HuffmanException::archiveFormatError("Invalid Huffman code in compressed data");
+    }
+
+    const uint16_t* table = entries.data();
+    BitReader reader(data, size);
+    size_t i = 0;
+
+    // Bulk loop: one refill, then several symbols without checking the buffer
+    while (i + kSymbolsPerRefill <= count)
+    {
+        reader.refill();
+        for (unsigned k = 0; k < kSymbolsPerRefill; k++)
+        {
+            out[i++] = decodeSymbol(reader, table);
+        }
+    }
+
+    for (; i < count; i++)
+    {
+        reader.refill();
+        out[i] = decodeSymbol(reader, table);
+    }
+
+    if (reader.getBitsConsumed() > totalBits)
+    {
+        throw HuffmanException::archiveFormatError("Compressed data ended before all symbols were decoded");
+    }
+    return reader.getBitsConsumed();
+}
+
+void HuffmanDecoder::decodeInterleaved(const unsigned char* const data[], const size_t size[],
+                                       const size_t totalBits[], unsigned char* out, size_t count) const
+{
+    if (count > 0 && entries.empty())
+    {
+        throw HuffmanException::archiveFormatError("Invalid Huffman code in compressed data");
+    }
+
+    const uint16_t* table = entries.data();
+    BitReader reader0(data[0], size[0]);
+    BitReader reader1(data[1], size[1]);
+    BitReader reader2(data[2], size[2]);
+    BitReader reader3(data[3], size[3]);
+    size_t i = 0;
+
+    // Each round refills all readers once and takes several symbols from
+    // each; the four lookup chains do not depend on each other
+    const size_t kRoundSymbols = kSymbolsPerRefill * kInterleavedStreams;
+    while (i + kRoundSymbols <= count)
+    {
+        reader0.refill();
+        reader1.refill();
+        reader2.refill();
+        reader3.refill();
+        for (unsigned k = 0; k < kSymbolsPerRefill; k++)
+        {
+            out[i] = decodeSymbol(reader0, table);
+            out[i + 1] = decodeSymbol(reader1, table);
+            out[i + 2] = decodeSymbol(reader2, table);
+            out[i + 3] = decodeSymbol(reader3, table);
+            i += kInterleavedStreams;
+        }
+    }
+
+    BitReader* readers[kInterleavedStreams] = {&reader0, &reader1, &reader2, &reader3};
+    for (; i < count; i++)
+    {
+        BitReader& reader = *readers[i % kInterleavedStreams];
+        reader.refill();
+        out[i] = decodeSymbol(reader, table);
+    }
+
+    for (unsigned stream = 0; stream < kInterleavedStreams; stream++)
+    {
+        if (readers[stream]->getBitsConsumed() > totalBits[stream])
+        {
+            throw HuffmanException::archiveFormatError("Compressed data ended before all symbols were decoded");
+        }
+    }
+}
+
+void HuffmanDecoder::decodeContexts(const std::vector<HuffmanDecoder>& decoders, const uint8_t tableOf[256],
+                                    const unsigned char* const data[], const size_t size[],
+                                    const size_t totalBits[], unsigned char* out, size_t count)
+{
+    static_assert(ContextModel::kStreamCount == 4, "decodeContexts advances four streams");
+    if (decoders.empty())
+    {
+        throw HuffmanException::archiveFormatError("Invalid Huffman code in compressed data");
+    }
+    unsigned tableBits = decoders[0].tableBits;
+    for (const HuffmanDecoder& decoder : decoders)
+    {
+        if (decoder.entries.empty() || decoder.tableBits != tableBits)
+        {
+            throw HuffmanException::archiveFormatError("Invalid Huffman code in compressed data");
+        }
+    }
+    const uint16_t* byContext[256];
+    for (int context = 0; context < 256; context++)
+    {
+        if (tableOf[context] >= decoders.size())
+        {
+            throw HuffmanException::archiveFormatError("Invalid Huffman code in compressed data");
+        }
+        byContext[context] = decoders[tableOf[context]].entries.data();
+    }
+    const HuffmanDecoder& decoder = decoders[0];
+
+    size_t begin[4], end[4];
+    for (unsigned stream = 0; stream < 4; stream++)
+    {
+        ContextModel::segment(count, stream, begin[stream], end[stream]);
+    }
+    BitReader reader0(data[0], size[0]);
+    BitReader reader1(data[1], size[1]);
+    BitReader reader2(data[2], size[2]);
+    BitReader reader3(data[3], size[3]);
+    unsigned char* out0 = out + begin[0];
+    unsigned char* out1 = out + begin[1];
+    unsigned char* out2 = out + begin[2];
+    unsigned char* out3 = out + begin[3];
+    const uint16_t* table0 = byContext[0];
+    const uint16_t* table1 = byContext[0];
+    const uint16_t* table2 = byContext[0];
+    const uint16_t* table3 = byContext[0];
+
+    // The last segment is the shortest; all four advance together over
+    // its length, and the longer segments finish one at a time
+    size_t shortest = end[3] - begin[3];
+    size_t i = 0;
+    while (i + kSymbolsPerRefill <= shortest)
+    {
+        reader0.refill();
+        reader1.refill();
+        reader2.refill();
+        reader3.refill();
+        for (unsigned k = 0; k < kSymbolsPerRefill; k++, i++)
+        {
+            out0[i] = decoder.decodeSymbol(reader0, table0);
+            out1[i] = decoder.decodeSymbol(reader1, table1);
+            out2[i] = decoder.decodeSymbol(reader2, table2);
+            out3[i] = decoder.decodeSymbol(reader3, table3);
+            table0 = byContext[out0[i]];
+            table1 = byContext[out1[i]];
+            table2 = byContext[out2[i]];
+            table3 = byContext[out3[i]];
+        }
+    }
+
+    BitReader* readers[4] = {&reader0, &reader1, &reader2, &reader3};
+    const uint16_t* tables[4] = {table0, table1, table2, table3};
+    for (unsigned stream = 0; stream < 4; stream++)
+    {
+        BitReader& reader = *readers[stream];
+        const uint16_t* table = tables[stream];
+        for (size_t j = begin[stream] + i; j < end[stream]; j++)
+        {
+            reader.refill();
+            out[j] = decoder.decodeSymbol(reader, table);
+            table = byContext[out[j]];
+        }
+        if (reader.getBitsConsumed() > totalBits[stream])
+        {
+            throw HuffmanException::archiveFormatError("Compressed data ended before all symbols were decoded");
+        }
+    }
+}
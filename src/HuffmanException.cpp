@@ -68,3 +68,10 @@ HuffmanException HuffmanException::archiveFormatError(const std::string& message
     oss << "Error: Invalid archive format - " << message;
     return HuffmanException(oss.str(), HuffmanErrorCode::ArchiveFormatError);
 }
+
+HuffmanException HuffmanException::invalidArgument(const std::string& flag, const std::string& value)
+{
+    std::ostringstream oss;
+    oss << "Error: Invalid value '" << value << "' for " << flag;
+    return HuffmanException(oss.str(), HuffmanErrorCode::InvalidArgument);
+}
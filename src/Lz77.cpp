@@ -0,0 +1,476 @@
+#include "../include/Lz77.h"
+#include "../include/ArchiveIO.h"
+#include "../include/ArchiveStructures.h"
+#include "../include/BitStream.h"
+#include "../include/HuffmanAlgorithm.h"
+#include "../include/HuffmanException.h"
+#include <algorithm>
+#include <cstring>
+
+const unsigned Lz77::kMinLevel;
+const unsigned Lz77::kMaxLevel;
+const unsigned Lz77::kDefaultLevel;
+const size_t Lz77::kMinMatch;
+const size_t Lz77::kMinWindow;
+const size_t Lz77::kMaxWindow;
+const size_t Lz77::kDefaultWindow;
+
+Lz77::Parameters::Parameters()
+    : level(kDefaultLevel), window(kDefaultWindow)
+{
+}
+
+// Match finder effort per level: hash chain steps, lazy matching, and the
+// match length that ends the search early. As in zlib, the lazy search at
+// the next position walks a quarter of the chain once the current match is
+// already good (kGoodLength or longer).
+struct LevelSettings {
+    unsigned maxChain;
+    bool lazy;
+    size_t niceLength;
+};
+
+static const LevelSettings kLevels[Lz77::kMaxLevel + 1] = {
+    {0, false, 0},
+    {4, false, 16},
+    {8, false, 32},
+    {16, false, 32},
+    {16, true, 64},
+    {32, true, 128},
+    {128, true, 128},
+    {256, true, 256},
+    {1024, true, 258},
+    {4096, true, 258},
+};
+
+static const size_t kGoodLength = 32;
+
+// Matches are cut at this length; longer repeats become several matches
+static const size_t kMaxMatch = 65536;
+
+// Number of values coded directly before the two-codes-per-power-of-two
+// scheme takes over: 16 for lengths, 4 for distances
+static const unsigned kLengthDirect = 16;
+static const unsigned kDistanceDirect = 4;
+
+// Split a value into its code, extra bits and extra bit count. Values below
+// direct are their own code; larger values with top bit n get one of two
+// codes per n (the bit below the top one picks which) and n - 1 extra bits.
+static void splitValue(uint32_t value, unsigned direct, unsigned char& code, uint32_t& extra, unsigned& extraBits)
+{
+    if (value < direct)
+    {
+        code = static_cast<unsigned char>(value);
+        extra = 0;
+        extraBits = 0;
+        return;
+    }
+    unsigned directBits = 0;
+    while ((1u << (directBits + 1)) <= direct)
+    {
+        directBits++;
+    }
+    unsigned topBit = 31;
+    while ((value >> topBit) == 0)
+    {
+        topBit--;
+    }
+    extraBits = topBit - 1;
+    extra = value & ((1u << extraBits) - 1);
+    code = static_cast<unsigned char>(direct + (topBit - directBits) * 2 + ((value >> extraBits) & 1));
+}
+
+// Estimated costs, in 1/16 bits, used to decide whether a match pays for
+// itself. A match always costs a literal-run code, a length code and a
+// distance code (a few bits each once Huffman coded) plus the extra bits of
+// the literal run before it, its length and its distance, so a short match
+// far back can cost more than the literals it replaces.
+static const int32_t kCostScale = 16;
+static const int32_t kSequenceCost = 10 * kCostScale;
+
+// Number of extra bits splitValue emits for value
+static unsigned extraBitCount(uint32_t value, unsigned direct)
+{
+    if (value < direct)
+    {
+        return 0;
+    }
+    unsigned topBit = 31;
+    while ((value >> topBit) == 0)
+    {
+        topBit--;
+    }
+    return topBit - 1;
+}
+
+// 16 * log2(value) for value >= 1, interpolated linearly between powers of
+// two; integer only so the archive is the same on every platform
+static int64_t log2Scaled(uint64_t value)
+{
+    unsigned topBit = 63;
+    while ((value >> topBit) == 0)
+    {
+        topBit--;
+    }
+    uint64_t fraction = topBit > 0 ? ((value - (uint64_t(1) << topBit)) << 4) >> topBit : 0;
+    return static_cast<int64_t>(topBit) * kCostScale + static_cast<int64_t>(fraction);
+}
+
+// Average cost of a literal: the block's order-0 entropy, at least one bit
+static int32_t literalCost(const unsigned char* data, size_t size)
+{
+    uint64_t counts[256] = {0};
+    HuffmanAlgorithm::countByteFrequencies(data, size, counts);
+    int64_t total = 0;
+    for (int symbol = 0; symbol < 256; symbol++)
+    {
+        if (counts[symbol] != 0)
+        {
+            total += static_cast<int64_t>(counts[symbol]) * (log2Scaled(size) - log2Scaled(counts[symbol]));
+        }
+    }
+    int64_t average = size > 0 ? total / static_cast<int64_t>(size) : 0;
+    return static_cast<int32_t>(std::max<int64_t>(average, kCostScale));
+}
+
+// Inverse of splitValue, reading the extra bits from reader
+static uint32_t joinValue(unsigned char code, unsigned direct, BitReader& reader)
+{
+    if (code < direct)
+    {
+        return code;
+    }
+    unsigned directBits = 0;
+    while ((1u << (directBits + 1)) <= direct)
+    {
+        directBits++;
+    }
+    unsigned topBit = (code - direct) / 2 + directBits;
+    if (topBit > 31)
+    {
+        throw HuffmanException::archiveFormatError("Invalid LZ77 code");
+    }
+    unsigned extraBits = topBit - 1;
+    reader.refill();
+    uint32_t extra = extraBits > 0 ? static_cast<uint32_t>(reader.peek(extraBits)) : 0;
+    reader.consume(extraBits);
+    return (1u << topBit) | (static_cast<uint32_t>((code - direct) & 1) << extraBits) | extra;
+}
+
+// A candidate match and the bits it saves over coding its bytes as literals
+struct Match {
+    size_t length;
+    size_t distance;
+    int32_t gain;
+
+    Match() : length(0), distance(0), gain(0) {}
+};
+
+// Hash-chain match finder over one block. Positions are stored plus one,
+// so 0 marks an empty slot; the chain links live in a ring indexed by the
+// low bits of the position. Matches are ranked by their estimated gain, not
+// their length alone.
+class MatchFinder {
+    static const unsigned kHashBits = 16;
+
+    const unsigned char* data;
+    size_t size;
+    size_t window;
+    size_t ringMask;
+    LevelSettings settings;
+    int32_t literalBits;
+    std::vector<uint32_t> head;
+    std::vector<uint32_t> chain;
+
+    uint32_t hashAt(size_t pos) const
+    {
+        // Assembled byte by byte so the hash, and with it the archive, is
+        // the same on every platform
+        uint32_t value = data[pos] | (data[pos + 1] << 8) | (data[pos + 2] << 16) |
+                         (static_cast<uint32_t>(data[pos + 3]) << 24);
+        return (value * 2654435761u) >> (32 - kHashBits);
+    }
+
+    size_t matchLength(size_t candidate, size_t pos, size_t limit) const
+    {
+        size_t length = 0;
+        while (length + 8 <= limit &&
+               std::memcmp(data + candidate + length, data + pos + length, 8) == 0)
+        {
+            length += 8;
+        }
+        while (length < limit && data[candidate + length] == data[pos + length])
+        {
+            length++;
+        }
+        return length;
+    }
+
+public:
+    MatchFinder(const unsigned char* blockData, size_t blockSize, const Lz77::Parameters& parameters)
+        : data(blockData), size(blockSize), window(std::min(parameters.window, blockSize)),
+          settings(kLevels[parameters.level]), literalBits(literalCost(blockData, blockSize)),
+          head(size_t(1) << kHashBits, 0)
+    {
+        size_t ringSize = 1;
+        while (ringSize < window)
+        {
+            ringSize <<= 1;
+        }
+        ringMask = ringSize - 1;
+        chain.assign(ringSize, 0);
+    }
+
+    const LevelSettings& getSettings() const
+    {
+        return settings;
+    }
+
+    // Make pos findable by later searches
+    void insert(size_t pos)
+    {
+        if (pos + Lz77::kMinMatch <= size)
+        {
+            uint32_t hash = hashAt(pos);
+            chain[pos & ringMask] = head[hash];
+            head[hash] = static_cast<uint32_t>(pos + 1);
+        }
+    }
+
+    // Estimated bits saved by a match instead of its literals, when
+    // literalRun literals precede it
+    int32_t gain(size_t length, size_t distance, size_t literalRun) const
+    {
+        int32_t cost = kSequenceCost + kCostScale * static_cast<int32_t>(
+            extraBitCount(static_cast<uint32_t>(literalRun), kLengthDirect) +
+            extraBitCount(static_cast<uint32_t>(length - Lz77::kMinMatch), kLengthDirect) +
+            extraBitCount(static_cast<uint32_t>(distance - 1), kDistanceDirect));
+        return static_cast<int32_t>(length) * literalBits - cost;
+    }
+
+    // Match for pos, after literalRun pending literals, among earlier
+    // inserted positions that is longer than current and saves more bits
+    // (and saves any at all); length 0 if there is none. Candidates come
+    // nearest first, so a later one can only save more by being longer.
+    Match find(size_t pos, size_t literalRun, const Match& current = Match()) const
+    {
+        Match best = current;
+        if (pos + Lz77::kMinMatch > size)
+        {
+            return Match();
+        }
+        size_t limit = std::min(kMaxMatch, size - pos);
+        unsigned maxChain = current.length >= kGoodLength ? settings.maxChain / 4 + 1 : settings.maxChain;
+        size_t longest = std::min(current.length, limit - 1);
+        uint32_t next = head[hashAt(pos)];
+        for (unsigned steps = 0; next != 0 && steps < maxChain; steps++)
+        {
+            size_t candidate = next - 1;
+            if (candidate >= pos || pos - candidate > window)
+            {
+                break;
+            }
+            if (data[candidate + longest] == data[pos + longest])
+            {
+                size_t length = matchLength(candidate, pos, limit);
+                if (length > longest && length >= Lz77::kMinMatch)
+                {
+                    longest = length;
+                    int32_t saved = gain(length, pos - candidate, literalRun);
+                    if (saved > best.gain)
+                    {
+                        best.length = length;
+                        best.distance = pos - candidate;
+                        best.gain = saved;
+                    }
+                    if (length >= settings.niceLength || length == limit)
+                    {
+                        break;
+                    }
+                }
+            }
+
+            // A link to a later position means the ring slot was reused
+            uint32_t link = chain[candidate & ringMask];
+            if (link >= next)
+            {
+                break;
+            }
+            next = link;
+        }
+        return best.gain > current.gain && best.length >= Lz77::kMinMatch ? best : Match();
+    }
+};
+
+// Code a byte stream as a nested block and append it, unless it is empty
+static void writeStream(ArchiveWriter& out, const std::vector<unsigned char>& symbols, unsigned maxCodeLength)
+{
+    if (!symbols.empty())
+    {
+        CompressionStatistics stats;
+        HuffmanAlgorithm::compressBlock(symbols.data(), symbols.size(), stats, maxCodeLength).writeTo(out);
+    }
+}
+
+static std::vector<unsigned char> readStream(ArchiveReader& in, size_t count)
+{
+    std::vector<unsigned char> symbols(count);
+    if (count > 0)
+    {
+        ArchiveBlock block = ArchiveBlock::parse(in, count, SharedCodeTables());
+        if (block.originalSize != count || block.mode == ArchiveBlock::Lz77 ||
+            block.mode == ArchiveBlock::Bwt)
+        {
+            throw HuffmanException::archiveFormatError("Invalid LZ77 stream");
+        }
+        HuffmanAlgorithm::decompressBlock(block, symbols.data());
+    }
+    return symbols;
+}
+
+std::vector<unsigned char> Lz77::compress(const unsigned char* data, size_t size,
+                                          const Parameters& parameters, unsigned maxCodeLength)
+{
+    MatchFinder finder(data, size, parameters);
+    const LevelSettings& settings = finder.getSettings();
+
+    std::vector<unsigned char> literals;
+    std::vector<unsigned char> literalRunCodes;
+    std::vector<unsigned char> lengthCodes;
+    std::vector<unsigned char> distanceCodes;
+    BitWriter extraBits;
+
+    auto emitValue = [&extraBits](std::vector<unsigned char>& codes, uint32_t value, unsigned direct)
+    {
+        unsigned char code;
+        uint32_t extra;
+        unsigned bits;
+        splitValue(value, direct, code, extra, bits);
+        codes.push_back(code);
+        extraBits.writeBits(extra, bits);
+    };
+
+    size_t pos = 0;
+    size_t literalStart = 0;
+    while (pos + kMinMatch <= size)
+    {
+        Match match = finder.find(pos, pos - literalStart);
+        finder.insert(pos);
+        if (match.length == 0)
+        {
+            pos++;
+            continue;
+        }
+
+        // Lazy matching: while the next position has a match that saves
+        // more, emit this byte as a literal and take that match instead
+        while (settings.lazy && match.length < settings.niceLength)
+        {
+            Match nextMatch = finder.find(pos + 1, pos + 1 - literalStart, match);
+            if (nextMatch.length == 0)
+            {
+                break;
+            }
+            pos++;
+            finder.insert(pos);
+            match = nextMatch;
+        }
+        size_t length = match.length;
+        size_t distance = match.distance;
+
+        literals.insert(literals.end(), data + literalStart, data + pos);
+        emitValue(literalRunCodes, static_cast<uint32_t>(pos - literalStart), kLengthDirect);
+        emitValue(lengthCodes, static_cast<uint32_t>(length - kMinMatch), kLengthDirect);
+        emitValue(distanceCodes, static_cast<uint32_t>(distance - 1), kDistanceDirect);
+        for (size_t p = pos + 1; p < pos + length; p++)
+        {
+            finder.insert(p);
+        }
+        pos += length;
+        literalStart = pos;
+    }
+    literals.insert(literals.end(), data + literalStart, data + size);
+
+    ArchiveWriter out;
+    out.writeU32(static_cast<uint32_t>(lengthCodes.size()));
+    out.writeU32(static_cast<uint32_t>(literals.size()));
+    writeStream(out, literals, maxCodeLength);
+    writeStream(out, literalRunCodes, maxCodeLength);
+    writeStream(out, lengthCodes, maxCodeLength);
+    writeStream(out, distanceCodes, maxCodeLength);
+    size_t bitCount = extraBits.getBitCount();
+    std::vector<unsigned char> bits = extraBits.release();
+    out.writeU64(bitCount);
+    out.writeBytes(bits.data(), bits.size());
+    return out.data();
+}
+
+void Lz77::decompress(const unsigned char* payload, size_t payloadSize,
+                      unsigned char* out, size_t outSize)
+{
+    ArchiveReader in(payload, payloadSize);
+    size_t sequenceCount = in.readU32();
+    size_t literalCount = in.readU32();
+    if (literalCount > outSize || sequenceCount > outSize / kMinMatch)
+    {
+        throw HuffmanException::archiveFormatError("Invalid LZ77 block");
+    }
+    std::vector<unsigned char> literals = readStream(in, literalCount);
+    std::vector<unsigned char> literalRunCodes = readStream(in, sequenceCount);
+    std::vector<unsigned char> lengthCodes = readStream(in, sequenceCount);
+    std::vector<unsigned char> distanceCodes = readStream(in, sequenceCount);
+    uint64_t bitCount = in.readU64();
+    if (bitCount > static_cast<uint64_t>(in.remaining()) * 8)
+    {
+        throw HuffmanException::archiveFormatError("Invalid LZ77 block");
+    }
+    size_t bitBytes = static_cast<size_t>((bitCount + 7) / 8);
+    BitReader extraBits(in.readBytes(bitBytes), bitBytes);
+
+    unsigned char* write = out;
+    unsigned char* end = out + outSize;
+    const unsigned char* literal = literals.data();
+    const unsigned char* literalsEnd = literal + literals.size();
+    for (size_t i = 0; i < sequenceCount; i++)
+    {
+        size_t run = joinValue(literalRunCodes[i], kLengthDirect, extraBits);
+        size_t length = joinValue(lengthCodes[i], kLengthDirect, extraBits) + kMinMatch;
+        size_t distance = static_cast<size_t>(joinValue(distanceCodes[i], kDistanceDirect, extraBits)) + 1;
+        if (run > static_cast<size_t>(literalsEnd - literal) || run > static_cast<size_t>(end - write) ||
+            length > static_cast<size_t>(end - write) - run || distance > static_cast<size_t>(write - out) + run)
+        {
+            throw HuffmanException::archiveFormatError("Invalid LZ77 sequence");
+        }
+        std::memcpy(write, literal, run);
+        write += run;
+        literal += run;
+
+        // Overlapping matches repeat the last distance bytes
+        const unsigned char* source = write - distance;
+        if (distance >= length)
+        {
+            std::memcpy(write, source, length);
+        }
+        else
+        {
+            for (size_t k = 0; k < length; k++)
+            {
+                write[k] = source[k];
+            }
+        }
+        write += length;
+    }
+
+    size_t trailing = static_cast<size_t>(literalsEnd - literal);
+    if (trailing != static_cast<size_t>(end - write) || extraBits.getBitsConsumed() > bitCount)
+    {
+        throw HuffmanException::archiveFormatError("Invalid LZ77 block");
+    }
+    std::memcpy(write, literal, trailing);
+}
+
+std::string Lz77::describe(const Parameters& parameters)
+{
+    return "LZ77+Huffman (level " + std::to_string(parameters.level) + ", window " +
+           std::to_string(parameters.window) + " bytes)";
+}
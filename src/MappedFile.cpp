@@ -0,0 +1,132 @@
+#include "../include/MappedFile.h"
+#include "../include/HuffmanException.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path, bool sequentialAccess)
+    : mappedData(nullptr), mappedSize(0), fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr)
+{
+    DWORD flags = sequentialAccess ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL;
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                             OPEN_EXISTING, flags, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        throw HuffmanException::fileError(path, "open");
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+        return;
+
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle == nullptr)
+        return;
+
+    void* view = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (view != nullptr)
+    {
+        mappedData = static_cast<const unsigned char*>(view);
+        mappedSize = static_cast<size_t>(fileSize.QuadPart);
+    }
+}
+
+void MappedFile::release(size_t offset, size_t length) const
+{
+    // Pages of a read-only view are reclaimed by the OS as needed
+    (void)offset;
+    (void)length;
+}
+
+MappedFile::~MappedFile()
+{
+    if (mappedData != nullptr)
+        UnmapViewOfFile(mappedData);
+    if (mappingHandle != nullptr)
+        CloseHandle(mappingHandle);
+    if (fileHandle != INVALID_HANDLE_VALUE)
+        CloseHandle(fileHandle);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path, bool sequentialAccess)
+    : mappedData(nullptr), mappedSize(0)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw HuffmanException::fileError(path, "open");
+    }
+
+    // Only regular, non-empty files can be mapped; others use stream reads
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0)
+    {
+        void* mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED)
+        {
+            mappedData = static_cast<const unsigned char*>(mapping);
+            mappedSize = static_cast<size_t>(info.st_size);
+            if (sequentialAccess)
+            {
+                madvise(mapping, mappedSize, MADV_SEQUENTIAL);
+            }
+        }
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+}
+
+void MappedFile::release(size_t offset, size_t length) const
+{
+    if (mappedData == nullptr || offset >= mappedSize)
+        return;
+    if (length > mappedSize - offset)
+        length = mappedSize - offset;
+    
+    // madvise() works on whole pages: shrink the range to page boundaries
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t first = (offset + pageSize - 1) / pageSize * pageSize;
+    size_t last = (offset + length) / pageSize * pageSize;
+    if (offset + length == mappedSize)
+        last = mappedSize;   // the partial tail page belongs to this range only
+    if (last > first)
+    {
+        madvise(const_cast<unsigned char*>(mappedData) + first, last - first, MADV_DONTNEED);
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (mappedData != nullptr)
+    {
+        munmap(const_cast<unsigned char*>(mappedData), mappedSize);
+    }
+}
+
+#endif
+
+bool MappedFile::isMapped() const
+{
+    return mappedData != nullptr;
+}
+
+const unsigned char* MappedFile::data() const
+{
+    return mappedData;
+}
+
+size_t MappedFile::size() const
+{
+    return mappedSize;
+}
@@ -0,0 +1,50 @@
+#include "../include/ThreadPool.h"
+
+ThreadPool::ThreadPool(size_t threadCount)
+    : stopping(false)
+{
+    if (threadCount > 1)
+    {
+        for (size_t i = 0; i < threadCount; i++)
+        {
+            workers.emplace_back(&ThreadPool::workerLoop, this);
+        }
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueCondition.notify_all();
+
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::getThreadCount() const
+{
+    return workers.empty() ? 1 : workers.size();
+}
+
+void ThreadPool::workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCondition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty())
+                return;   // stopping and nothing left to run
+
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
@@ -0,0 +1,244 @@
+#!/bin/sh
+# Round-trip and corruption checks for the huff binary.
+# Usage: tests/check.sh <path to huff>
+#
+# Every block mode (coded, stored, run-length, order-1 context, delta, LZ77,
+# BWT) is encoded, decoded and compared byte for byte, shard archives are
+# joined with cat and decoded as one, and damaged archives must be rejected
+# with an error instead of a crash or a hang.
+
+HUFF=${1:-build/release/huff}
+case "$HUFF" in
+    /*) ;;
+    *) HUFF="$(pwd)/$HUFF" ;;
+esac
+
+if [ ! -x "$HUFF" ]; then
+    echo "check: $HUFF is not an executable" >&2
+    exit 2
+fi
+
+SRC_ROOT=$(cd "$(dirname "$0")/.." && pwd)
+WORK=$(mktemp -d "${TMPDIR:-/tmp}/huff-check.XXXXXX") || exit 2
+trap 'rm -rf "$WORK"' EXIT
+# Work inside the scratch directory: the decoder's mkdir fallback redirects
+# to "nul", which a POSIX shell creates as a file in the working directory
+cd "$WORK" || exit 2
+
+passed=0
+failed=0
+
+pass()
+{
+    passed=$((passed + 1))
+}
+
+fail()
+{
+    failed=$((failed + 1))
+    echo "FAIL: $1"
+}
+
+# Test inputs, one per kind of data a block mode is meant for
+DATA="$WORK/data"
+mkdir -p "$DATA/text" "$DATA/bin" "$DATA/dup"
+
+cat "$SRC_ROOT"/src/*.cpp "$SRC_ROOT"/include/*.h > "$DATA/text/source.txt"
+cat "$DATA/text/source.txt" "$DATA/text/source.txt" > "$DATA/text/source2.txt"
+cp "$SRC_ROOT/README.md" "$DATA/text/readme.md"
+: > "$DATA/text/empty.txt"
+printf 'x' > "$DATA/text/one.txt"
+
+# Incompressible bytes end up in stored blocks
+head -c 200000 /dev/urandom > "$DATA/bin/random.bin"
+
+# Long runs separated by short noise, for --rle
+{
+    head -c 70000 /dev/zero
+    head -c 300 /dev/urandom
+    head -c 90000 /dev/zero | tr '\000' '\377'
+    head -c 300 /dev/urandom
+    head -c 50000 /dev/zero
+} > "$DATA/bin/runs.bin"
+
+# Slowly changing 16-bit little-endian samples on two channels, for --delta
+LC_ALL=C awk 'BEGIN {
+    for (i = 0; i < 40000; i++)
+    {
+        a = (1000 + int(i / 3)) % 65536
+        b = (30000 + int(500 * sin(i / 200))) % 65536
+        printf "%c%c%c%c", a % 256, int(a / 256), b % 256, int(b / 256)
+    }
+}' > "$DATA/bin/telemetry.bin"
+
+# The same base name in two directories; the later entry is restored
+cp "$SRC_ROOT/Makefile" "$DATA/dup/Makefile"
+mkdir -p "$DATA/dup/sub"
+cp "$SRC_ROOT/README.md" "$DATA/dup/sub/Makefile"
+
+INPUTS="text/source.txt text/source2.txt text/readme.md text/empty.txt text/one.txt
+bin/random.bin bin/runs.bin bin/telemetry.bin"
+
+# Decodes archive $2 into a fresh directory and compares it with the inputs
+# named by the remaining arguments; decoding restores base names only
+compare_decoded()
+{
+    name=$1
+    archive=$2
+    shift 2
+    out="$WORK/out-$name"
+    rm -rf "$out"
+    if ! "$HUFF" -d "$archive" -o "$out" > "$WORK/log" 2>&1; then
+        fail "$name: decode failed"
+        cat "$WORK/log"
+        return
+    fi
+    for file in "$@"; do
+        if ! cmp -s "$DATA/$file" "$out/$(basename "$file")"; then
+            fail "$name: $file differs after decode"
+            return
+        fi
+    done
+    pass
+}
+
+# Encodes all inputs with the given options, then tests, decodes and compares
+round_trip()
+{
+    name=$1
+    shift
+    archive="$WORK/$name.huf"
+    # shellcheck disable=SC2086
+    if ! (cd "$DATA" && "$HUFF" -e $INPUTS -o "$archive" "$@") > "$WORK/log" 2>&1; then
+        fail "$name: encode failed"
+        cat "$WORK/log"
+        return
+    fi
+    if ! "$HUFF" -t "$archive" > "$WORK/log" 2>&1; then
+        fail "$name: archive test failed"
+        cat "$WORK/log"
+        return
+    fi
+    # shellcheck disable=SC2086
+    compare_decoded "$name" "$archive" $INPUTS
+}
+
+echo "Round trips"
+round_trip coded
+round_trip small-blocks -b 4K -j 4
+round_trip short-codes --max-code-len 11
+round_trip rle --rle
+round_trip order1 --order1
+round_trip delta-auto --delta auto
+round_trip delta-4 --delta 4 -b 64K
+round_trip lz77 -m lz77
+round_trip lz77-fast -m lz77 --level 1 --window 4K -b 64K -j 3
+round_trip lz77-all -m lz77 --level 9 --rle --delta auto
+round_trip bwt -m bwt -b 64K -j 2
+round_trip bwt-order1 -m bwt --order1 --rle
+
+# A global code from a frequency table
+if (cd "$DATA" && "$HUFF" -f $INPUTS -o "$WORK/all.freq") > "$WORK/log" 2>&1; then
+    round_trip code-from --code-from "$WORK/all.freq" -b 16K
+else
+    fail "code-from: frequency count failed"
+    cat "$WORK/log"
+fi
+
+# Extracting one file by name
+rm -rf "$WORK/out-extract"
+if "$HUFF" -x "$WORK/coded.huf" readme.md -o "$WORK/out-extract" > "$WORK/log" 2>&1 &&
+    cmp -s "$DATA/text/readme.md" "$WORK/out-extract/readme.md"; then
+    pass
+else
+    fail "extract: readme.md not restored"
+fi
+
+(cd "$DATA" && "$HUFF" -e dup/Makefile dup/sub/Makefile -o "$WORK/dup.huf") > "$WORK/log" 2>&1
+rm -rf "$WORK/out-dup"
+if "$HUFF" -d "$WORK/dup.huf" -o "$WORK/out-dup" > "$WORK/log" 2>&1 &&
+    cmp -s "$DATA/dup/sub/Makefile" "$WORK/out-dup/Makefile"; then
+    pass
+else
+    fail "duplicate names: the last entry was not restored"
+fi
+
+echo "Shards joined with cat"
+for mode in "" "-m lz77" "--rle -b 8K"; do
+    shards=""
+    for i in 0 1 2; do
+        # shellcheck disable=SC2086
+        (cd "$DATA" && "$HUFF" -e $INPUTS --shard $i/3 -o "$WORK/part$i.huf" $mode) \
+            > "$WORK/log" 2>&1 || fail "shard $i/3 ($mode): encode failed"
+        shards="$shards $WORK/part$i.huf"
+    done
+    # shellcheck disable=SC2086
+    cat $shards > "$WORK/joined.huf"
+    if "$HUFF" -t "$WORK/joined.huf" > "$WORK/log" 2>&1; then
+        # shellcheck disable=SC2086
+        compare_decoded joined "$WORK/joined.huf" $INPUTS
+    else
+        fail "shards ($mode): joined archive test failed"
+        cat "$WORK/log"
+    fi
+done
+
+# One big file split into shards must come back as one file
+(cd "$DATA" && "$HUFF" -e text/source2.txt --shard 0/2 -b 8K -o "$WORK/big0.huf" &&
+    "$HUFF" -e text/source2.txt --shard 1/2 -b 8K -o "$WORK/big1.huf") > "$WORK/log" 2>&1
+cat "$WORK/big0.huf" "$WORK/big1.huf" > "$WORK/big.huf"
+compare_decoded big-shards "$WORK/big.huf" text/source2.txt
+
+echo "Corrupted archives"
+# Overwrites bytes across each archive; testing the damaged archive must end
+# with an ordinary exit status (0 when only unchecked metadata changed, 1 on
+# a detected error), never a signal or a timeout
+corrupt_checks()
+{
+    archive=$1
+    size=$(wc -c < "$archive")
+    step=$((size / 40 + 1))
+    offset=0
+    while [ "$offset" -lt "$size" ]; do
+        for value in '\000' '\377' '\125'; do
+            cp "$archive" "$WORK/damaged.huf"
+            # shellcheck disable=SC2059
+            printf "$value" | dd of="$WORK/damaged.huf" bs=1 seek="$offset" conv=notrunc 2> /dev/null
+            timeout 20 "$HUFF" -t "$WORK/damaged.huf" > "$WORK/log" 2>&1
+            status=$?
+            if [ "$status" -gt 1 ]; then
+                fail "corrupt $(basename "$archive") at byte $offset: exit status $status"
+                return
+            fi
+        done
+        offset=$((offset + step))
+    done
+    # A truncated archive is always an error
+    head -c $((size / 2)) "$archive" > "$WORK/damaged.huf"
+    if timeout 20 "$HUFF" -t "$WORK/damaged.huf" > "$WORK/log" 2>&1; then
+        fail "truncated $(basename "$archive") passed the test"
+        return
+    fi
+    pass
+}
+
+for name in coded small-blocks rle order1 delta-auto lz77 bwt code-from; do
+    corrupt_checks "$WORK/$name.huf"
+done
+
+# A changed byte in the first file's blocks must be reported, not silently
+# decoded (the trailing metadata section is informational and unchecked)
+cp "$WORK/coded.huf" "$WORK/damaged.huf"
+offset=1000
+byte=$(dd if="$WORK/damaged.huf" bs=1 skip="$offset" count=1 2> /dev/null | od -An -tu1 | tr -d ' ')
+# shellcheck disable=SC2059
+printf "\\$(printf '%03o' $(((byte + 1) % 256)))" |
+    dd of="$WORK/damaged.huf" bs=1 seek="$offset" conv=notrunc 2> /dev/null
+if timeout 20 "$HUFF" -t "$WORK/damaged.huf" > "$WORK/log" 2>&1; then
+    fail "changed payload byte passed the test"
+else
+    pass
+fi
+
+echo "$passed passed, $failed failed"
+[ "$failed" -eq 0 ]